@@ -0,0 +1,473 @@
+// Banc de mesure des opérations publiques de NDarray.
+// Chaque opération est mesurée pour plusieurs types d'éléments et trois tailles de données
+// (small : tient en L1, l2 : tient en L2, ram : dépasse le cache). Une ligne par mesure
+// est écrite sur la sortie standard, en JSON (défaut) ou en CSV (--csv).
+//
+//   g++ -std=c++17 -O3 -pthread bench.cpp -o bench
+//   ./bench [--csv] [--op nom,...] [--dtype float32] [--size small,l2] [--threads n]
+//           [--min-time s] [--ram-mb n]
+//
+// Compilé avec -DNDARRAY_INSTRUMENT, chaque ligne indique en plus les octets copiés par appel
+// et le temps passé dans chaque opération interne.
+#include "ndarray.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+// Options de la ligne de commande
+struct Config
+{
+    bool csv = false;
+    vector<string> ops;                        // Sous-chaînes du nom des opérations à mesurer (toutes si vide)
+    vector<string> dtypes;                     // Types à mesurer (tous si vide)
+    vector<string> sizes{"small", "l2", "ram"}; // Tailles à mesurer
+    size_t threads = 0;                        // 0 : nombre de threads par défaut du pool
+    double min_time = 0.2;                     // Durée minimale de mesure d'un cas, en secondes
+    size_t ram_mb = 64;                        // Taille d'un opérande pour la taille ram, en Mio
+};
+
+// Description d'un cas mesuré : le débit est calculé à partir des octets lus et écrits et
+// des opérations flottantes d'un appel
+struct Case
+{
+    string op;
+    string dtype;
+    string size;
+    string shape;
+    double bytes = 0;
+    double flops = 0;
+};
+
+template <typename T>
+const char *dtype_name();
+template <>
+const char *dtype_name<float>() { return "float32"; }
+template <>
+const char *dtype_name<double>() { return "float64"; }
+template <>
+const char *dtype_name<int32_t>() { return "int32"; }
+template <>
+const char *dtype_name<int64_t>() { return "int64"; }
+
+// Empêche le compilateur d'éliminer un résultat inutilisé
+template <typename V>
+inline void keep(const V &value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+string shape_str(const vector<size_t> &shape)
+{
+    string s;
+    for (size_t i = 0; i < shape.size(); ++i)
+        s += (i ? "x" : "") + to_string(shape[i]);
+    return s;
+}
+
+// Centile par rang le plus proche sur des échantillons triés
+double percentile(const vector<double> &sorted, double p)
+{
+    size_t rank = static_cast<size_t>(ceil(p / 100.0 * sorted.size()));
+    return sorted[rank ? rank - 1 : 0];
+}
+
+class Bench
+{
+public:
+    explicit Bench(const Config &c) : cfg(c)
+    {
+        if (cfg.csv)
+            cout << "op,dtype,size,shape,threads,samples,batch,min_ns,p50_ns,p90_ns,p99_ns,mean_ns,gbps,gflops,allocs_per_call"
+                 << (nd::instrument::enabled ? ",bytes_copied_per_call" : "") << "\n";
+    }
+
+    bool wanted(const string &op) const
+    {
+        return cfg.ops.empty() || any_of(cfg.ops.begin(), cfg.ops.end(), [&](const string &o)
+                                         { return op.find(o) != string::npos; });
+    }
+
+    /**
+     * Mesure fn : un appel d'échauffement, puis des échantillons jusqu'à min_time secondes (au moins 10).
+     * Un échantillon regroupe assez d'appels pour durer environ 20 µs, ce qui rend négligeable le coût
+     * de la lecture de l'horloge pour les opérations très courtes ; sa durée est ramenée à un appel.
+     */
+    template <typename F>
+    void run(const Case &c, F &&fn)
+    {
+        if (!wanted(c.op))
+            return;
+        fn();
+        auto t0 = Clock::now();
+        fn();
+        double once = chrono::duration<double, nano>(Clock::now() - t0).count();
+        size_t batch = once >= 20000.0 ? 1 : static_cast<size_t>(20000.0 / max(once, 1.0)) + 1;
+
+        nd::MemoryStats before = nd::memory_stats();
+        nd::instrument::reset();
+        vector<double> samples;
+        size_t calls = 0;
+        auto start = Clock::now();
+        while (samples.size() < 10 || chrono::duration<double>(Clock::now() - start).count() < cfg.min_time)
+        {
+            auto s0 = Clock::now();
+            for (size_t i = 0; i < batch; ++i)
+                fn();
+            samples.push_back(chrono::duration<double, nano>(Clock::now() - s0).count() / batch);
+            calls += batch;
+        }
+        nd::instrument::Report report = nd::instrument::report();
+        double allocs = static_cast<double>(nd::memory_stats().allocations - before.allocations) / calls;
+
+        vector<double> sorted = samples;
+        sort(sorted.begin(), sorted.end());
+        double mean = 0;
+        for (double s : samples)
+            mean += s;
+        mean /= samples.size();
+        double p50 = percentile(sorted, 50);
+        double gbps = c.bytes > 0 ? c.bytes / p50 : NAN; // octets par ns = Go/s
+        double gflops = c.flops > 0 ? c.flops / p50 : NAN;
+        double copied = static_cast<double>(report.bytes_copied) / calls;
+
+        ostringstream out;
+        out << fixed;
+        out.precision(1);
+        if (cfg.csv)
+        {
+            out << c.op << ',' << c.dtype << ',' << c.size << ',' << c.shape << ',' << nd::num_threads() << ','
+                << samples.size() << ',' << batch << ',' << sorted.front() << ',' << p50 << ','
+                << percentile(sorted, 90) << ',' << percentile(sorted, 99) << ',' << mean << ','
+                << number(gbps) << ',' << number(gflops) << ',' << allocs;
+            if (nd::instrument::enabled)
+                out << ',' << copied;
+        }
+        else
+        {
+            out << "{\"op\":\"" << c.op << "\",\"dtype\":\"" << c.dtype << "\",\"size\":\"" << c.size
+                << "\",\"shape\":\"" << c.shape << "\",\"threads\":" << nd::num_threads()
+                << ",\"samples\":" << samples.size() << ",\"batch\":" << batch
+                << ",\"min_ns\":" << sorted.front() << ",\"p50_ns\":" << p50
+                << ",\"p90_ns\":" << percentile(sorted, 90) << ",\"p99_ns\":" << percentile(sorted, 99)
+                << ",\"mean_ns\":" << mean << ",\"gbps\":" << json_number(gbps)
+                << ",\"gflops\":" << json_number(gflops) << ",\"allocs_per_call\":" << allocs;
+            if (nd::instrument::enabled)
+            {
+                // Temps moyen par appel mesuré passé dans chaque opération interne
+                out << ",\"bytes_copied_per_call\":" << copied << ",\"ops\":{";
+                for (size_t i = 0; i < report.ops.size(); ++i)
+                    out << (i ? "," : "") << '"' << report.ops[i].name << "\":{\"calls_per_call\":"
+                        << static_cast<double>(report.ops[i].calls) / calls << ",\"ns_per_call\":"
+                        << report.ops[i].total_ms * 1e6 / calls << '}';
+                out << '}';
+            }
+            out << '}';
+        }
+        cout << out.str() << endl;
+    }
+
+private:
+    static string number(double v) { return isnan(v) ? string() : to_string(v); }
+    static string json_number(double v) { return isnan(v) ? string("null") : to_string(v); }
+
+    const Config &cfg;
+};
+
+// Nombre d'éléments d'un opérande pour une taille donnée
+template <typename T>
+size_t elements_for(const Config &cfg, const string &size)
+{
+    size_t bytes = size == "small" ? 4096 : size == "l2" ? 256 * 1024 : cfg.ram_mb * 1024 * 1024;
+    return max<size_t>(bytes / sizeof(T), 16);
+}
+
+// Côté d'une matrice carrée dont trois exemplaires occupent environ budget éléments
+size_t square_side(size_t budget)
+{
+    return max<size_t>(static_cast<size_t>(sqrt(budget / 3.0)), 4);
+}
+
+// Opérations disponibles pour tous les types
+template <typename T>
+void bench_common(Bench &bench, const Config &cfg, const string &size)
+{
+    const string dt = dtype_name<T>();
+    const double sz = sizeof(T);
+    size_t n = elements_for<T>(cfg, size);
+    size_t cols = 64;
+    size_t rows = n / cols;
+    n = rows * cols;
+    string flat = to_string(n), mat = shape_str({rows, cols});
+
+    T hi = std::is_integral<T>::value ? T(100) : T(1);
+    NDarray<T> a = NDarray<T>::rand({n}, T(1), hi);
+    NDarray<T> b = NDarray<T>::rand({n}, T(1), hi);
+    NDarray<T> c = NDarray<T>::rand({n}, T(1), hi);
+    NDarray<T> m = a.reshaped({rows, cols});
+    NDarray<T> row = NDarray<T>::rand({cols}, T(1), hi);
+
+    // Arithmétique élément par élément
+    bench.run({"add", dt, size, flat, 3 * n * sz, double(n)}, [&]
+              { NDarray<T> r = a + b; keep(r); });
+    bench.run({"fused_mul_add", dt, size, flat, 3 * n * sz, 2.0 * n}, [&]
+              { NDarray<T> r = a * b + c; keep(r); });
+    bench.run({"subtract", dt, size, flat, 3 * n * sz, double(n)}, [&]
+              { NDarray<T> r = a - b; keep(r); });
+    bench.run({"divide", dt, size, flat, 3 * n * sz, double(n)}, [&]
+              { NDarray<T> r = a / b; keep(r); });
+    bench.run({"scalar_mul", dt, size, flat, 2 * n * sz, double(n)}, [&]
+              { NDarray<T> r = a * T(3); keep(r); });
+    NDarray<T> zero = NDarray<T>::zeros({n}); // Ajouter des zéros laisse c inchangé d'un appel à l'autre
+    NDarray<T> one = NDarray<T>::ones({n});   // De même pour la division (et le produit sans dépassement)
+    bench.run({"iadd", dt, size, flat, 3 * n * sz, double(n)}, [&]
+              { c += zero; keep(c); });
+    bench.run({"idiv", dt, size, flat, 3 * n * sz, double(n)}, [&]
+              { c /= one; keep(c); });
+    bench.run({"broadcast_add", dt, size, mat, 2 * n * sz, double(n)}, [&]
+              { NDarray<T> r = m + row; keep(r); });
+
+    // Vues et copies
+    bench.run({"slice_view", dt, size, mat, 0, 0}, [&]
+              { NDarray<T> v = m[{Slice(1, rows, 2), Slice(0, cols, 2)}]; keep(v); });
+    bench.run({"reshape", dt, size, mat, 0, 0}, [&]
+              { NDarray<T> v = m.reshaped({cols, rows}); keep(v); });
+    bench.run({"flatten", dt, size, mat, 2 * n * sz, 0}, [&]
+              { NDarray<T> r = m.flatten(); keep(r); });
+    NDarray<T> strided = m[{Slice(0, rows, 2), Slice(0, cols, 2)}];
+    bench.run({"slice_copy", dt, size, shape_str(strided.getShape()), 2.0 * strided.getSize() * sz, 0}, [&]
+              { NDarray<T> r = strided.copy(); keep(r); });
+    bench.run({"copy", dt, size, flat, 2 * n * sz, 0}, [&]
+              { NDarray<T> r = a.copy(); keep(r); });
+    bench.run({"transpose_copy", dt, size, mat, 2 * n * sz, 0}, [&]
+              { NDarray<T> r = m.transpose().copy(); keep(r); });
+    bench.run({"concatenate", dt, size, flat + "+" + flat, 4 * n * sz, 0}, [&]
+              { NDarray<T> r = NDarray<T>::concatenate({a, b}); keep(r); });
+    bench.run({"concatenate_axis1", dt, size, mat + "+" + mat, 4 * n * sz, 0}, [&]
+              { NDarray<T> r = NDarray<T>::concatenate({m, m}, 1); keep(r); });
+    bench.run({"stack", dt, size, flat + "+" + flat, 4 * n * sz, 0}, [&]
+              { NDarray<T> r = NDarray<T>::stack({a, b}); keep(r); });
+    bench.run({"hstack", dt, size, mat + "+" + mat, 4 * n * sz, 0}, [&]
+              { NDarray<T> r = NDarray<T>::hstack({m, m}); keep(r); });
+    bench.run({"vstack", dt, size, mat + "+" + mat, 4 * n * sz, 0}, [&]
+              { NDarray<T> r = NDarray<T>::vstack({m, m}); keep(r); });
+
+    // Accès à un élément avec vérification des bornes (un appel = une lecture)
+    size_t k = 0;
+    bench.run({"at", dt, size, mat, sz, 0}, [&]
+              {
+                  T v = m.at({k, k % cols});
+                  k = k + 1 < rows ? k + 1 : 0;
+                  keep(v); });
+
+    // Réductions
+    bench.run({"sum", dt, size, flat, n * sz, double(n)}, [&]
+              { T s = a.sum(); keep(s); });
+    bench.run({"sum_axis0", dt, size, mat, n * sz, double(n)}, [&]
+              { NDarray<T> r = m.sum(0); keep(r); });
+    bench.run({"sum_axis1", dt, size, mat, n * sz, double(n)}, [&]
+              { NDarray<T> r = m.sum(1); keep(r); });
+    bench.run({"prod", dt, size, flat, n * sz, double(n)}, [&]
+              { T s = one.prod(); keep(s); });
+    bench.run({"min", dt, size, flat, n * sz, double(n)}, [&]
+              { T s = a.min(); keep(s); });
+    bench.run({"max", dt, size, flat, n * sz, double(n)}, [&]
+              { T s = a.max(); keep(s); });
+    bench.run({"argmin", dt, size, flat, n * sz, double(n)}, [&]
+              { size_t s = a.argmin(); keep(s); });
+    bench.run({"argmax", dt, size, flat, n * sz, double(n)}, [&]
+              { size_t s = a.argmax(); keep(s); });
+    bench.run({"mean", dt, size, flat, n * sz, double(n)}, [&]
+              { auto s = a.mean(); keep(s); });
+    bench.run({"var", dt, size, flat, 2 * n * sz, 3.0 * n}, [&]
+              { auto s = a.var(); keep(s); });
+    bench.run({"stddev", dt, size, flat, 2 * n * sz, 3.0 * n}, [&]
+              { auto s = a.stddev(); keep(s); });
+    bench.run({"var_axis0", dt, size, mat, 2 * n * sz, 3.0 * n}, [&]
+              { auto r = m.var(0); keep(r); });
+
+    // Création
+    size_t side = square_side(n);
+    bench.run({"zeros", dt, size, flat, n * sz, 0}, [&]
+              { NDarray<T> r = NDarray<T>::zeros({n}); keep(r); });
+    bench.run({"full", dt, size, flat, n * sz, 0}, [&]
+              { NDarray<T> r = NDarray<T>::full({n}, T(7)); keep(r); });
+    bench.run({"linspace", dt, size, flat, n * sz, 0}, [&]
+              { NDarray<T> r = NDarray<T>::linspace(T(0), T(n), n); keep(r); });
+    bench.run({"eye", dt, size, shape_str({side, side}), double(side) * side * sz, 0}, [&]
+              { NDarray<T> r = NDarray<T>::eye(side); keep(r); });
+
+    // Génération
+    bench.run({"rand", dt, size, flat, n * sz, 0}, [&]
+              { NDarray<T> r = NDarray<T>::rand({n}, T(0), hi); keep(r); });
+    if constexpr (std::is_integral<T>::value)
+        bench.run({"randint", dt, size, flat, n * sz, 0}, [&]
+                  { NDarray<T> r = NDarray<T>::randint(T(0), T(1000), {n}); keep(r); });
+    else
+        bench.run({"randn", dt, size, flat, n * sz, 0}, [&]
+                  { NDarray<T> r = NDarray<T>::randn({n}); keep(r); });
+    bench.run({"arange", dt, size, flat, n * sz, 0}, [&]
+              { NDarray<T> r = NDarray<T>::arange(T(0), T(n), T(1)); keep(r); });
+
+    // Entrées / sorties .npy (fichier temporaire, en général dans le cache de pages)
+    if (bench.wanted("save") || bench.wanted("load"))
+    {
+        string path = (filesystem::temp_directory_path() / ("ndarray_bench_" + dt + "_" + size + ".npy")).string();
+        bench.run({"save", dt, size, mat, n * sz, 0}, [&]
+                  { m.save(path); });
+        m.save(path);
+        bench.run({"load", dt, size, mat, n * sz, 0}, [&]
+                  { NDarray<T> r = NDarray<T>::load(path); keep(r); });
+        bench.run({"load_map", dt, size, mat, 0, 0}, [&]
+                  { NDarray<T> r = NDarray<T>::load(path, nd::LoadMode::map); keep(r); });
+        filesystem::remove(path);
+    }
+}
+
+// Produits matriciels (types flottants)
+template <typename T>
+void bench_linalg(Bench &bench, const Config &cfg, const string &size)
+{
+    const string dt = dtype_name<T>();
+    const double sz = sizeof(T);
+    size_t budget = elements_for<T>(cfg, size);
+    // Au-delà, un produit dure plusieurs secondes par appel sur une petite machine
+    size_t side = min<size_t>(square_side(budget), 1024);
+    string sq = shape_str({side, side});
+
+    NDarray<T> a = NDarray<T>::rand({side, side}, T(-1), T(1));
+    NDarray<T> b = NDarray<T>::rand({side, side}, T(-1), T(1));
+    NDarray<T> x = NDarray<T>::rand({side}, T(-1), T(1));
+    double s = static_cast<double>(side);
+
+    bench.run({"dot", dt, size, sq, 3 * s * s * sz, 2 * s * s * s}, [&]
+              { NDarray<T> r = NDarray<T>::dot(a, b); keep(r); });
+    bench.run({"dot_transposed", dt, size, sq, 3 * s * s * sz, 2 * s * s * s}, [&]
+              { NDarray<T> r = NDarray<T>::dot(a.transpose(), b); keep(r); });
+    bench.run({"gemv", dt, size, sq, (s * s + 2 * s) * sz, 2 * s * s}, [&]
+              { NDarray<T> r = NDarray<T>::dot(a, x); keep(r); });
+
+    // Lot de petites matrices 32 x 32
+    size_t batch = max<size_t>(budget / (3 * 32 * 32), 1);
+    NDarray<T> ba = NDarray<T>::rand({batch, 32, 32}, T(-1), T(1));
+    NDarray<T> bb = NDarray<T>::rand({batch, 32, 32}, T(-1), T(1));
+    double nb = static_cast<double>(batch);
+    bench.run({"matmul_batched", dt, size, shape_str({batch, 32, 32}), 3 * nb * 32 * 32 * sz, 2 * nb * 32 * 32 * 32}, [&]
+              { NDarray<T> r = NDarray<T>::matmul(ba, bb); keep(r); });
+}
+
+// Tableaux de rang statique : petits tableaux sans allocation
+template <typename T>
+void bench_static(Bench &bench, const string &size)
+{
+    if (size != "small")
+        return;
+    const string dt = dtype_name<T>();
+    NDarray<T, 2> m({3, 3}, T(1));
+    bench.run({"static_create_3x3", dt, size, "3x3", 9 * sizeof(T), 0}, [&]
+              { NDarray<T, 2> r({3, 3}, T(2)); keep(r); });
+    bench.run({"static_copy_3x3", dt, size, "3x3", 18 * sizeof(T), 0}, [&]
+              { NDarray<T, 2> r(m); keep(r); });
+    bench.run({"static_add_3x3", dt, size, "3x3", 27 * sizeof(T), 9}, [&]
+              { NDarray<T, 2> r = m + m; keep(r); });
+}
+
+template <typename T>
+void bench_type(Bench &bench, const Config &cfg)
+{
+    string dt = dtype_name<T>();
+    if (!cfg.dtypes.empty() && find(cfg.dtypes.begin(), cfg.dtypes.end(), dt) == cfg.dtypes.end())
+        return;
+    for (const string &size : cfg.sizes)
+    {
+        bench_common<T>(bench, cfg, size);
+        if constexpr (std::is_floating_point<T>::value)
+            bench_linalg<T>(bench, cfg, size);
+        bench_static<T>(bench, size);
+    }
+}
+
+vector<string> split(const string &s)
+{
+    vector<string> parts;
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ','))
+        if (!item.empty())
+            parts.push_back(item);
+    return parts;
+}
+
+void usage()
+{
+    cerr << "Usage : bench [--csv] [--op nom,...] [--dtype float32,float64,int32,int64]\n"
+            "              [--size small,l2,ram] [--threads n] [--min-time s] [--ram-mb n]\n";
+}
+
+int main(int argc, char **argv)
+{
+    Config cfg;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        auto value = [&]() -> string
+        {
+            if (i + 1 >= argc)
+            {
+                usage();
+                exit(1);
+            }
+            return argv[++i];
+        };
+        if (arg == "--csv")
+            cfg.csv = true;
+        else if (arg == "--op")
+            cfg.ops = split(value());
+        else if (arg == "--dtype")
+            cfg.dtypes = split(value());
+        else if (arg == "--size")
+            cfg.sizes = split(value());
+        else if (arg == "--threads")
+            cfg.threads = stoul(value());
+        else if (arg == "--min-time")
+            cfg.min_time = stod(value());
+        else if (arg == "--ram-mb")
+            cfg.ram_mb = stoul(value());
+        else
+        {
+            usage();
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+    for (const string &size : cfg.sizes)
+        if (size != "small" && size != "l2" && size != "ram")
+        {
+            cerr << "Taille inconnue : " << size << "\n";
+            return 1;
+        }
+    if (cfg.threads > 0)
+        nd::set_num_threads(cfg.threads);
+
+    Bench bench(cfg);
+    bench_type<float>(bench, cfg);
+    bench_type<double>(bench, cfg);
+    bench_type<int32_t>(bench, cfg);
+    bench_type<int64_t>(bench, cfg);
+    return 0;
+}
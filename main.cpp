@@ -1,4 +1,6 @@
 #include "ndarray.h"
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 
 using namespace std;
@@ -63,6 +65,63 @@ int main()
     cout << "\nTableau randint(0, 10, (2, 3)) : " << endl;
     arrRandInt.print();
 
+    // Test de randn et d'un générateur à graine explicite (mêmes valeurs à chaque exécution)
+    NDarray<double> arrRandn = NDarray<double>::randn({2, 3});
+    cout << "\nTableau randn(2, 3) : " << endl;
+    arrRandn.print();
+    nd::Generator gen(42);
+    NDarray<float> arrUniform = gen.uniform<float>({2, 3}, 0.0f, 1.0f);
+    cout << "\nTableau Generator(42).uniform((2, 3)) : " << endl;
+    arrUniform.print();
+
+    // Vecteurs de test de Philox4x32-10 (Random123 : compteur et clé nuls, tous les bits à 1, décimales de pi).
+    // Le bloc isolé doit donner la valeur attendue, et chaque version du calcul par groupes de 16 blocs
+    // (scalaire et vectorielles disponibles) les mêmes blocs que philox_block.
+    struct PhiloxKat
+    {
+        uint64_t key, stream, ctr;
+        uint32_t expected[4];
+    };
+    const PhiloxKat kats[] = {
+        {0, 0, 0, {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+        {~0ull, ~0ull, ~0ull, {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+        {0x299f31d0a4093822, 0x0370734413198a2e, 0x85a308d3243f6a88, {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}}};
+    using GroupKernel = void (*)(uint64_t, uint64_t, uint64_t, size_t, uint32_t *);
+    vector<pair<string, GroupKernel>> kernels{{"scalaire", nd::detail::philox_scalar}};
+#ifdef NDARRAY_X86_DISPATCH
+#ifdef __SSE2__
+    kernels.push_back({"sse2", nd::detail::philox_sse2});
+#endif
+    if (nd::detail::detect_isa() != nd::detail::Isa::generic)
+        kernels.push_back({"avx2", nd::detail::philox_avx2});
+    if (nd::detail::detect_isa() == nd::detail::Isa::avx512)
+        kernels.push_back({"avx512", nd::detail::philox_avx512});
+#endif
+    bool katOk = true;
+    for (const PhiloxKat &kat : kats)
+    {
+        uint32_t block[4];
+        nd::detail::philox_block(kat.key, kat.stream, kat.ctr, block);
+        katOk = katOk && equal(block, block + 4, kat.expected);
+        for (const auto &kernel : kernels)
+        {
+            uint32_t group[nd::detail::group_words];
+            kernel.second(kat.key, kat.stream, kat.ctr, 1, group);
+            for (size_t i = 0; i < nd::detail::philox_group; ++i)
+            {
+                nd::detail::philox_block(kat.key, kat.stream, kat.ctr + i, block);
+                for (size_t k = 0; k < 4; ++k)
+                    katOk = katOk && group[k * nd::detail::philox_group + i] == block[k];
+            }
+        }
+    }
+    cout << "\nPhilox4x32-10, vecteurs de test (zéro, uns, pi) : " << (katOk ? "OK" : "ÉCHEC") << " (bloc, groupes";
+    for (const auto &kernel : kernels)
+        cout << " " << kernel.first;
+    cout << ")" << endl;
+    if (!katOk)
+        return 1;
+
     // Test de l'indexation
     cout << "\nAccès à arr1[0, 1] : " << arr1.at({0, 1}) << endl;
 
@@ -97,6 +156,18 @@ int main()
     NDarray<int> col1 = arr[{Slice(0, 3), Slice(1, 2)}];
     col1.print(); // Devrait afficher [[10], [11], [12]] ou [10, 11, 12] selon l'affichage
 
+    // Test des vues : le slicing, transpose et reshaped partagent les données
+    NDarray<int> arrT = arr2D.transpose();
+    cout << "\nTransposée de arr2D (vue) : " << endl;
+    arrT.print();
+    NDarray<int> rowView = arr2D[{Slice(0, 1)}];
+    rowView.at({0, 0}) = 99; // Modifie aussi arr2D
+    cout << "\narr2D après écriture dans la vue arr2D[0:1] : " << endl;
+    arr2D.print();
+    cout << "Vue contiguë : " << rowView.is_contiguous() << ", transposée contiguë : " << arrT.is_contiguous() << endl;
+    cout << "\nCopie contiguë de la transposée : " << endl;
+    arrT.copy().print();
+
     // Test de reshape
     NDarray<int> arrReshaped = arr2;
     arrReshaped.reshape({6, 2});
@@ -120,6 +191,14 @@ int main()
     cout << "\nConcaténation verticale arr2 et arr1 : " << endl;
     arrVConcat.print();
 
+    // Concaténation de plusieurs tableaux et empilement
+    NDarray<int> arrNConcat = NDarray<int>::concatenate({arr2_mod, arr1_mod, arr2_mod}, 1);
+    cout << "\nConcaténation de trois tableaux le long de l'axe 1 : " << endl;
+    arrNConcat.print();
+    NDarray<int> arrStack = NDarray<int>::stack({arr2_mod, arr1_mod});
+    cout << "\nEmpilement stack(arr2_mod, arr1_mod), forme : ";
+    printShape(arrStack.getShape());
+
     // Opérations arithmétiques
     NDarray<int> arrA({2, 2}, 4);
     NDarray<int> arrB({2, 2}, 2);
@@ -149,6 +228,42 @@ int main()
     NDarray<int> scalarMul = arrA * 2;
     scalarMul.print();
 
+    // Expression fusionnée : une seule passe et une seule allocation
+    cout << "\nExpression fusionnée (arrA * 2 + arrB - arrA) : " << endl;
+    NDarray<int> fused = arrA * 2 + arrB - arrA;
+    fused.print();
+
+    // Opérateurs composés : écriture directe dans le tableau
+    cout << "\nOpérateurs composés (arrA += arrB ; arrA *= 3) : " << endl;
+    NDarray<int> arrC = arrA;
+    arrC += arrB;
+    arrC *= 3;
+    arrC.print();
+
+    // Diffusion (broadcasting) : la ligne est réutilisée pour chaque ligne de la matrice, sans copie
+    NDarray<int> bias = NDarray<int>::arange(0, 3, 1);
+    cout << "\nDiffusion (arr2D[:, :3] + [0, 1, 2]) : " << endl;
+    NDarray<int> broadcast = arr2D[{Slice(0, 4), Slice(0, 3)}] + bias;
+    broadcast.print();
+
+    // Réductions
+    cout << "\nRéductions sur arr2D : sum = " << arr2D.sum() << ", max = " << arr2D.max()
+         << ", argmin = " << arr2D.argmin() << ", mean = " << arr2D.mean() << endl;
+    cout << "Somme le long de l'axe 0 : " << endl;
+    arr2D.sum(0).print();
+    cout << "Moyenne le long de l'axe 1 (keepdims) : " << endl;
+    arr2D.mean(1, true).print();
+
+    // Tableau de rang statique : forme sans allocation, accès direct m(i, j)
+    NDarray<double, 2> small({3, 3}, 0.0);
+    for (size_t i = 0; i < 3; ++i)
+        small(i, i) = 1.0;
+    cout << "\nTableau de rang statique NDarray<double, 2> (identité 3x3, stocké dans l'objet : "
+         << small.is_inline() << ") : " << endl;
+    small.print();
+    NDarray<int, 2> arr2DStatic(arr2D); // Vue de rang statique sur arr2D
+    cout << "arr2D(1, 2) via NDarray<int, 2> : " << arr2DStatic(1, 2) << endl;
+
     // Produit matriciel
     NDarray<int> mat1({2, 3}, 1);
     NDarray<int> mat2({3, 2}, 2);
@@ -156,6 +271,12 @@ int main()
     cout << "\nProduit matriciel dot(mat1, mat2) : " << endl;
     dotResult.print();
 
+    // Produit matriciel par lots (3D x 2D)
+    NDarray<int> batch({2, 2, 3}, 1);
+    NDarray<int> matmulResult = NDarray<int>::matmul(batch, mat2);
+    cout << "\nProduit matriciel par lots matmul(batch {2, 2, 3}, mat2) : " << endl;
+    matmulResult.print();
+
     // Test pour un tableau 3D
     NDarray<int> arr3D({2, 3, 4}, 1);
     cout << "\nTableau 3D initialisé à 1 (shape {2, 3, 4}) : " << endl;
@@ -171,5 +292,24 @@ int main()
     cout << "\nTableau 4D randint(0, 10, (2, 2, 2, 2)) : " << endl;
     arr4DRandInt.print();
 
+    // Enregistrement au format .npy puis rechargement par projection mémoire
+    arr4DRandInt.save("exemple.npy");
+    NDarray<int> loaded = NDarray<int>::load("exemple.npy", nd::LoadMode::map);
+    cout << "\nRechargé depuis exemple.npy (projection mémoire), somme = " << loaded.sum()
+         << " (attendu " << arr4DRandInt.sum() << ")" << endl;
+
+    // Une expression sur un temporaire projeté en mode partagé ne doit pas écrire dans le fichier
+    NDarray<int> doubled = NDarray<int>::load("exemple.npy", nd::LoadMode::map_shared) * 2;
+    bool mapOk = NDarray<int>::load("exemple.npy").sum() == arr4DRandInt.sum() &&
+                 doubled.sum() == 2 * arr4DRandInt.sum();
+    cout << "Expression sur une projection partagée, fichier inchangé : " << (mapOk ? "OK" : "ÉCHEC") << endl;
+    std::remove("exemple.npy");
+    if (!mapOk)
+        return 1;
+
+    nd::MemoryStats stats = nd::memory_stats();
+    cout << "\nMémoire : " << stats.allocations << " tampons alloués, pic " << stats.peak_bytes
+         << " octets, taux de recyclage du pool " << stats.hit_rate() << endl;
+
     return 0;
 }
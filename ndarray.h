@@ -5,12 +5,19 @@
 #include <vector>
 #include <string>
 #include <initializer_list>
+#include <functional>
+#include <memory>
 #include <random>
 #include <stdexcept>
 
-// Déclaration anticipée de la classe NDarray pour utilisation dans la structure Slice
-template <typename T>
-class NDarray;
+#include "ndarray_fwd.h"
+#include "ndarray_memory.h"
+#include "ndarray_instrument.h"
+#include "ndarray_expr.h"
+#include "ndarray_gemm.h"
+#include "ndarray_reduce.h"
+#include "ndarray_io.h"
+#include "ndarray_random.h"
 
 // Structure pour représenter une tranche (slice)
 // Une tranche définit une sous-partie d'un tableau avec un début, une fin et un pas
@@ -22,22 +29,55 @@ struct Slice
 };
 
 // Classe NDarray : implémente un tableau N-dimensionnel inspiré de NumPy
+// Les données sont stockées dans un tampon partagé (compté par référence) : le slicing,
+// transpose et reshaped renvoient des vues qui partagent ce tampon avec leur propre
+// forme, leurs pas (éventuellement négatifs) et leur décalage.
+// La copie d'un NDarray produit toujours un tableau contigu indépendant.
+// NDarray<T> est la version de rang dynamique ; NDarray<T, N> (ndarray_static.h) fixe le rang.
 template <typename T>
-class NDarray
+class NDarray<T, nd::dynamic_rank>
 {
+    template <typename U, size_t M>
+    friend class NDarray;
+    friend class nd::Generator;
+
 public:
+    using value_type = T; // Type des éléments
+
     // Initialise un tableau avec des dimensions spécifiées par une liste d'initialisation
     NDarray(std::initializer_list<size_t> dims, T value = T());
     // Initialise un tableau avec des dimensions spécifiées par un vecteur
     NDarray(std::vector<size_t> dims, T value = T());
 
+    // Copie profonde (le résultat est contigu) ; le déplacement conserve le tampon partagé
+    NDarray(const NDarray<T> &other);
+    NDarray(NDarray<T> &&other) noexcept = default;
+    NDarray<T> &operator=(const NDarray<T> &other);
+    NDarray<T> &operator=(NDarray<T> &&other) noexcept = default;
+
+    // Évalue une expression élément par élément (a * 2 + b - c) en une seule passe.
+    // Si l'expression contient un tableau temporaire de la bonne forme, son tampon est réutilisé.
+    template <typename E, typename = std::enable_if_t<nd::detail::is_expr<E>::value>>
+    NDarray(E &&expr);
+    template <typename E, typename = std::enable_if_t<nd::detail::is_expr<E>::value>>
+    NDarray<T> &operator=(E &&expr);
+
     // Affichage
     // Affiche le tableau dans un format lisible, similaire à NumPy
     void print() const;
 
     // Retourne le nombre total d'éléments dans le tableau
     size_t getSize() const;
-    std::vector<size_t> getShape() const { return shape; } // Retourne la forme (dimensions) du tableau
+    const std::vector<size_t> &getShape() const { return shape; }        // Retourne la forme (dimensions) du tableau
+    const std::vector<long long> &getStrides() const { return strides; } // Retourne les pas (en éléments) de chaque dimension
+
+    // Vrai si les éléments sont rangés de façon contiguë dans l'ordre C (ligne par ligne)
+    bool is_contiguous() const { return c_order; }
+    // Pointeur vers le premier élément logique (à parcourir avec getStrides())
+    T *data() { return storage.get() + offset; }
+    const T *data() const { return storage.get() + offset; }
+    // Vrai si les deux tableaux partagent le même tampon (l'un est une vue de l'autre)
+    bool shares_memory(const NDarray<T> &other) const { return storage == other.storage; }
 
     static NDarray<T> zeros(std::initializer_list<size_t> dims);
     static NDarray<T> ones(std::initializer_list<size_t> dims);
@@ -54,6 +94,23 @@ public:
      * @return NDarray<T> avec des entiers aléatoires.
      */
     static NDarray<T> randint(T low, T high, std::initializer_list<size_t> dims);
+    // Tableau de tirages de la loi normale N(mean, stddev^2) (numpy.random.normal)
+    static NDarray<T> randn(std::initializer_list<size_t> dims, T mean = T(0), T stddev = T(1));
+
+    // Entrées / sorties au format NumPy
+    /**
+     * @brief Charge un fichier .npy.
+     * @param path Chemin du fichier.
+     * @param mode copy lit les données en mémoire ; map et map_shared projettent le fichier :
+     *             le tableau pointe directement dans la projection et s'ouvre instantanément.
+     * @return NDarray<T> (un fichier en ordre Fortran donne une vue aux pas transposés, sans copie).
+     * @throws std::invalid_argument si le type du fichier ne correspond pas à T.
+     */
+    static NDarray<T> load(const std::string &path, nd::LoadMode mode = nd::LoadMode::copy);
+    // Charge le tableau name d'une archive .npz (membres non compressés)
+    static NDarray<T> load(const std::string &path, const std::string &name, nd::LoadMode mode = nd::LoadMode::copy);
+    // Enregistre le tableau au format .npy (ordre C) ; nd::NpyWriter écrit un fichier par morceaux
+    void save(const std::string &path) const;
 
     // Indexation
     // Accède à un élément spécifique via une liste d'indices (version modifiable)
@@ -61,6 +118,7 @@ public:
     // Accède à un élément spécifique via une liste d'indices (version constante)
     const T &at(std::initializer_list<size_t> indices) const;
     // Extrait une sous-partie du tableau via une liste de tranches (slicing)
+    // Le résultat est une vue : aucune donnée n'est copiée et les écritures sont visibles dans l'original
     NDarray<T> operator[](const std::vector<Slice> &slices) const;
 
     // Manipulation de forme
@@ -70,34 +128,64 @@ public:
      * @throws std::runtime_error Si la nouvelle forme est incompatible avec la taille actuelle.
      */
     void reshape(std::initializer_list<size_t> new_shape);
+    // Renvoie le tableau avec une nouvelle forme : une vue si le tableau est contigu, une copie sinon
+    NDarray<T> reshaped(std::vector<size_t> new_shape) const;
+    // Inverse l'ordre des axes (vue, sans copie)
+    NDarray<T> transpose() const;
+    // Permute les axes selon l'ordre donné (vue, sans copie)
+    NDarray<T> transpose(const std::vector<size_t> &axes) const;
     // Aplatit le tableau en un tableau 1D
     NDarray<T> flatten() const;
+    // Matérialise le tableau dans un nouveau tampon contigu
+    NDarray<T> copy() const;
+    // Renvoie une vue si le tableau est déjà contigu, une copie contiguë sinon
+    NDarray<T> contiguous() const;
     // Concatène deux tableaux le long d'un axe spécifié
     NDarray<T> concatenate(const NDarray<T> &other, size_t axis);
     // Concatène deux tableaux horizontalement
     NDarray<T> hstack(const NDarray<T> &other);
     // Concatène deux tableaux verticalement
     NDarray<T> vstack(const NDarray<T> &other);
+    // Élément d'une liste {a, b, ...} passée à concatenate, stack, hstack ou vstack : référence sans copie,
+    // qui accepte aussi un temporaire (valable jusqu'à la fin de l'appel)
+    class Input
+    {
+    public:
+        Input(const NDarray<T> &a) : array(&a) {}
+        const NDarray<T> *get() const { return array; }
+
+    private:
+        const NDarray<T> *array;
+    };
+    /**
+     * @brief Concatène un nombre quelconque de tableaux le long d'un axe, en une seule passe.
+     * Exemple : NDarray<float>::concatenate({a, b.transpose(), c}, 1)
+     * @throws std::runtime_error Si les formes diffèrent hors de l'axe de concaténation.
+     */
+    static NDarray<T> concatenate(std::initializer_list<Input> arrays, size_t axis = 0);
+    static NDarray<T> concatenate(const std::vector<NDarray<T>> &arrays, size_t axis = 0);
+    // Empile des tableaux de même forme le long d'un nouvel axe (numpy.stack)
+    static NDarray<T> stack(std::initializer_list<Input> arrays, size_t axis = 0);
+    static NDarray<T> stack(const std::vector<NDarray<T>> &arrays, size_t axis = 0);
+    // Concatène des tableaux horizontalement (numpy.hstack)
+    static NDarray<T> hstack(std::initializer_list<Input> arrays);
+    static NDarray<T> hstack(const std::vector<NDarray<T>> &arrays);
+    // Concatène des tableaux verticalement, les tableaux 1D devenant des lignes (numpy.vstack)
+    static NDarray<T> vstack(std::initializer_list<Input> arrays);
+    static NDarray<T> vstack(const std::vector<NDarray<T>> &arrays);
 
     // Opérateurs arithmétiques élément par élément
-    // Additionne deux tableaux élément par élément
-    NDarray<T> operator+(const NDarray<T> &other) const;
-    // Soustrait deux tableaux élément par élément
-    NDarray<T> operator-(const NDarray<T> &other) const;
-    // Multiplie deux tableaux élément par élément
-    NDarray<T> operator*(const NDarray<T> &other) const;
-    // Divise deux tableaux élément par élément
-    NDarray<T> operator/(const NDarray<T> &other) const;
-
-    // Opérations avec scalaires
-    // Ajoute un scalaire à chaque élément
-    NDarray<T> operator+(T scalar) const;
-    // Soustrait un scalaire à chaque élément
-    NDarray<T> operator-(T scalar) const;
-    // Multiplie chaque élément par un scalaire
-    NDarray<T> operator*(T scalar) const;
-    // Divise chaque élément par un scalaire
-    NDarray<T> operator/(T scalar) const;
+    // +, -, * et / (entre tableaux, expressions et scalaires) sont définis dans ndarray_expr.h
+    // et renvoient des expressions paresseuses évaluées lors de l'affectation.
+    // Les opérateurs composés écrivent directement dans le tableau (ou la vue) de destination.
+    template <typename B, typename = nd::detail::enable_compound_t<B>>
+    NDarray<T> &operator+=(B &&rhs);
+    template <typename B, typename = nd::detail::enable_compound_t<B>>
+    NDarray<T> &operator-=(B &&rhs);
+    template <typename B, typename = nd::detail::enable_compound_t<B>>
+    NDarray<T> &operator*=(B &&rhs);
+    template <typename B, typename = nd::detail::enable_compound_t<B>>
+    NDarray<T> &operator/=(B &&rhs);
 
     // Fonctions statiques pour opérations arithmétiques
     // Additionne deux tableaux (version fonctionnelle)
@@ -108,31 +196,112 @@ public:
     static NDarray<T> multiply(const NDarray<T> &a, const NDarray<T> &b);
     // Divise deux tableaux (version fonctionnelle)
     static NDarray<T> divide(const NDarray<T> &a, const NDarray<T> &b);
-    // Effectue un produit matriciel entre deux tableaux 2D
+    /**
+     * Produit matriciel, comme numpy.dot pour les tableaux 1D et 2D :
+     * 1D·1D produit scalaire (tableau 0D), 2D·1D et 1D·2D produit matrice-vecteur, 2D·2D produit de matrices.
+     * Au-delà, règle de numpy.dot : contraction du dernier axe de a avec l'avant-dernier axe de b
+     * (le seul axe de b s'il est 1D), résultat de forme a.shape[:-1] + b.shape[:-2] + b.shape[-1:].
+     * Pour des produits par lots, utiliser matmul.
+     * @throws std::invalid_argument Si les dimensions internes ne correspondent pas.
+     */
     static NDarray<T> dot(const NDarray<T> &a, const NDarray<T> &b);
+    /**
+     * Produit matriciel par lots, comme numpy.matmul : les deux derniers axes sont les matrices,
+     * les axes précédents sont des lots diffusés (taille égale ou 1). Un opérande 1D est traité
+     * comme un vecteur ligne (à gauche) ou colonne (à droite).
+     */
+    static NDarray<T> matmul(const NDarray<T> &a, const NDarray<T> &b);
+
+    // Réductions
+    // Sans argument : réduction de tout le tableau ; avec axis (négatif accepté) : réduction le long de cet axe.
+    // keepdims conserve l'axe réduit avec une taille 1 (pratique pour la diffusion : a - a.mean(1, true)).
+    // Les sommes flottantes sont calculées par paires (blocs contigus) ou avec compensation de Kahan.
+    T sum() const;
+    NDarray<T> sum(long long axis, bool keepdims = false) const;
+    T prod() const;
+    NDarray<T> prod(long long axis, bool keepdims = false) const;
+    // min et max propagent NaN ; lèvent std::invalid_argument sur un tableau vide
+    T min() const;
+    NDarray<T> min(long long axis, bool keepdims = false) const;
+    T max() const;
+    NDarray<T> max(long long axis, bool keepdims = false) const;
+    // Index de la première occurrence du minimum / maximum (index plat dans l'ordre C sans axis)
+    size_t argmin() const;
+    NDarray<size_t> argmin(long long axis, bool keepdims = false) const;
+    size_t argmax() const;
+    NDarray<size_t> argmax(long long axis, bool keepdims = false) const;
+    // Moyenne, variance et écart type (en double pour les tableaux d'entiers)
+    nd::detail::real_t<T> mean() const;
+    NDarray<nd::detail::real_t<T>> mean(long long axis, bool keepdims = false) const;
+    nd::detail::real_t<T> var() const;
+    NDarray<nd::detail::real_t<T>> var(long long axis, bool keepdims = false) const;
+    nd::detail::real_t<T> stddev() const;
+    NDarray<nd::detail::real_t<T>> stddev(long long axis, bool keepdims = false) const;
 
     // Accès direct (1D seulement)
     // Accède directement à un élément pour un tableau 1D (version modifiable)
+    // Pour un tableau à plusieurs dimensions, l'index est l'index plat dans l'ordre C
     T &operator[](size_t index) {
-        return data[index]; 
+        return c_order ? data()[index] : storage[offset_of(index)];
     }
     // Accède directement à un élément pour un tableau 1D (version constante)
     const T &operator[](size_t index) const { 
-        return data[index]; 
+        return c_order ? data()[index] : storage[offset_of(index)];
     }
 
 private:
+    // Construit une vue sur un tampon existant
+    NDarray(std::shared_ptr<T[]> buffer, size_t offset, std::vector<size_t> dims, std::vector<long long> steps);
+
+    // Crée un tableau contigu de forme dims sans initialiser ses éléments
+    static NDarray<T> uninitialized(const std::vector<size_t> &dims);
+    // Alloue un tampon de n éléments initialisés à value
+    static std::shared_ptr<T[]> allocate(size_t n, T value);
+    // Alloue un tampon de n éléments sans les initialiser (ils seront écrits ensuite), via nd::current_allocator()
+    static std::shared_ptr<T[]> allocate(size_t n);
+    // Implémentations de concatenate, stack, hstack et vstack sur une liste de tableaux
+    static NDarray<T> concatenate_all(const std::vector<const NDarray<T> *> &arrays, size_t axis);
+    static NDarray<T> stack_all(const std::vector<const NDarray<T> *> &arrays, size_t axis);
+    static NDarray<T> hstack_all(const std::vector<const NDarray<T> *> &arrays);
+    static NDarray<T> vstack_all(const std::vector<const NDarray<T> *> &arrays);
+    // Adresses des tableaux d'une liste d'entrées
+    static std::vector<const NDarray<T> *> pointers(std::initializer_list<Input> arrays);
+    static std::vector<const NDarray<T> *> pointers(const std::vector<NDarray<T>> &arrays);
+    // Produit de numpy.dot lorsqu'un opérande a plus de deux dimensions
+    static NDarray<T> dot_nd(const NDarray<T> &a, const NDarray<T> &b);
+    // Charge le flux .npy qui commence à la position pos du fichier
+    static NDarray<T> load_npy(const std::string &path, uint64_t pos, nd::LoadMode mode);
+    // Recalcule la taille totale et l'indicateur de contiguïté après un changement de forme ou de pas
+    void update_layout();
+    // Calcule les pas d'un tableau contigu (ordre C) pour la forme courante
+    void set_contiguous_strides();
+    // Position dans le tampon de l'élément d'index plat (ordre C) donné
+    size_t offset_of(size_t flat_index) const;
+    // Copie les éléments dans l'ordre C vers dst (qui doit pouvoir contenir getSize() éléments)
+    void copy_to(T *dst) const;
+    // Prépare une réduction le long de axis (toutes les dimensions si all_axes) et calcule la forme du résultat
+    nd::detail::ReduceLayout reduce_layout(long long axis, bool all_axes, bool keepdims, std::vector<size_t> &out_shape) const;
+    // Applique le réducteur R et renvoie le tableau des résultats (de type A)
+    template <typename R, typename A>
+    NDarray<A> reduce_to(long long axis, bool keepdims) const;
+    // Variance de chaque sortie de la disposition l, écrite dans out
+    template <typename A>
+    void variance(const nd::detail::ReduceLayout &l, A *out) const;
     // Méthode récursive pour afficher les tableaux multi-dimensionnels
-    void print_recursive(size_t dim, size_t start_idx, int indent = 0) const;
-    // Calcule l'index plat à partir d'une liste d'indices multi-dimensionnels
-    size_t get_flat_index(const std::vector<size_t> &indices) const;
+    void print_recursive(size_t dim, long long start_idx, int indent = 0) const;
+    // Calcule la position dans le tampon à partir d'une liste d'indices multi-dimensionnels
+    size_t get_flat_index(std::initializer_list<size_t> indices) const;
     // Normalise une tranche pour gérer les indices négatifs et vérifier les bornes
     void normalize_slice(Slice &slice, size_t dim_size) const;
 
-    std::vector<T> data;         // Stocke les données du tableau
-    std::vector<size_t> shape;   // Stocke les dimensions du tableau
-    std::vector<size_t> strides; // Stocke les pas (strides) pour chaque dimension
+    std::shared_ptr<T[]> storage;   // Tampon partagé entre le tableau et ses vues
+    size_t offset = 0;              // Position du premier élément dans le tampon
+    size_t total_size = 0;          // Nombre total d'éléments
+    bool c_order = true;            // Vrai si les pas correspondent à l'ordre C
+    std::vector<size_t> shape;      // Stocke les dimensions du tableau
+    std::vector<long long> strides; // Stocke les pas (strides) pour chaque dimension, négatifs possibles
 };
 
 #include "ndarray.tpp"
+#include "ndarray_static.h"
 #endif
@@ -1,4 +1,7 @@
 #include "ndarray.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
 #include <functional>
 #include <iomanip>
 #include <random>
@@ -8,56 +11,241 @@
 template <typename T>
 NDarray<T>::NDarray(std::initializer_list<size_t> dims, T value)
 {
-    shape = dims;                 // Définit la forme du tableau
-    size_t tsize = 1;             // Calcule la taille totale
+    shape = dims;             // Définit la forme du tableau
+    set_contiguous_strides(); // Calcule les pas et la taille totale
+    storage = allocate(total_size, value); // Initialise les données avec la valeur donnée
+}
+
+// Constructeur avec vecteur pour les dimensions
+template <typename T>
+NDarray<T>::NDarray(std::vector<size_t> dims, T value) : shape(dims)
+{
+    set_contiguous_strides(); // Calcule les pas et la taille totale
+    storage = allocate(total_size, value); // Initialise les données avec la valeur donnée
+}
+
+// Construit une vue partageant le tampon d'un autre tableau
+template <typename T>
+NDarray<T>::NDarray(std::shared_ptr<T[]> buffer, size_t off, std::vector<size_t> dims, std::vector<long long> steps)
+    : storage(std::move(buffer)), offset(off), shape(std::move(dims)), strides(std::move(steps))
+{
+    update_layout();
+}
+
+// Copie profonde : le nouveau tableau possède son propre tampon contigu
+template <typename T>
+NDarray<T>::NDarray(const NDarray<T> &other) : shape(other.shape)
+{
+    set_contiguous_strides();
+    storage = allocate(total_size);
+    other.copy_to(storage.get());
+}
+
+// Construit un tableau à partir d'une expression élément par élément (une seule passe)
+template <typename T>
+template <typename E, typename>
+NDarray<T>::NDarray(E &&expr) : shape(expr.shape())
+{
+    static_assert(std::is_same<typename std::decay_t<E>::value_type, T>::value,
+                  "Le type des éléments de l'expression doit correspondre à celui du tableau");
+    set_contiguous_strides();
+    NDarray<T> *donor = nullptr;
+    if constexpr (!std::is_lvalue_reference<E>::value)
+        donor = expr.donor(shape); // Tableau temporaire dont on peut réutiliser le tampon
+    // Seul un tampon venu d'allocate est réutilisé : une projection de fichier (LoadMode::map_shared)
+    // ou un tampon externe ne doit pas recevoir le résultat
+    if (donor && donor->storage.use_count() == 1 &&
+        std::get_deleter<nd::detail::BufferDeleter<T>>(donor->storage) != nullptr)
+    {
+        storage = donor->storage;
+        offset = donor->offset;
+    }
+    else
+    {
+        storage = allocate(total_size);
+    }
+    nd::detail::evaluate(expr, *this);
+}
+
+template <typename T>
+template <typename E, typename>
+NDarray<T> &NDarray<T>::operator=(E &&expr)
+{
+    NDarray<T> result(std::forward<E>(expr));
+    return *this = std::move(result);
+}
+
+template <typename T>
+NDarray<T> &NDarray<T>::operator=(const NDarray<T> &other)
+{
+    if (this != &other)
+    {
+        NDarray<T> tmp(other);
+        *this = std::move(tmp);
+    }
+    return *this;
+}
+
+// Crée un tableau contigu dont les éléments seront écrits ensuite
+template <typename T>
+NDarray<T> NDarray<T>::uninitialized(const std::vector<size_t> &dims)
+{
+    size_t n = 1;
+    for (size_t d : dims)
+        n *= d;
+    std::vector<long long> steps(dims.size());
+    long long step = 1;
+    for (size_t i = dims.size(); i > 0; --i)
+    {
+        steps[i - 1] = step;
+        step *= static_cast<long long>(dims[i - 1]);
+    }
+    return NDarray<T>(allocate(n), 0, dims, steps);
+}
+
+// Alloue un tampon de n éléments initialisés à value
+template <typename T>
+std::shared_ptr<T[]> NDarray<T>::allocate(size_t n, T value)
+{
+    NDARRAY_TIMED("fill");
+    std::shared_ptr<T[]> buffer = allocate(n);
+    T *p = buffer.get();
+    nd::parallel_for_elements(n, 1, [&](size_t lo, size_t hi)
+                              { std::fill(p + lo, p + hi, value); });
+    return buffer;
+}
+
+// Alloue un tampon de n éléments sans les initialiser, aligné sur 64 octets, avec l'allocateur courant
+template <typename T>
+std::shared_ptr<T[]> NDarray<T>::allocate(size_t n)
+{
+    return nd::detail::allocate_buffer<T>(n);
+}
+
+// Calcule les pas d'un tableau contigu (ordre C)
+template <typename T>
+void NDarray<T>::set_contiguous_strides()
+{
     strides.resize(shape.size()); // Redimensionne le vecteur des pas
+    size_t tsize = 1;
     for (size_t i = shape.size(); i > 0; --i)
     {
-        strides[i - 1] = tsize; // Calcule les pas pour chaque dimension
-        tsize *= shape[i - 1];  // Met à jour la taille totale
+        strides[i - 1] = static_cast<long long>(tsize); // Calcule les pas pour chaque dimension
+        tsize *= shape[i - 1];                          // Met à jour la taille totale
     }
-    data.resize(tsize, value); // Initialise les données avec la valeur donnée
+    total_size = tsize;
+    c_order = true;
 }
 
-// Constructeur avec vecteur pour les dimensions
+// Recalcule la taille totale et détermine si les pas correspondent à l'ordre C
 template <typename T>
-NDarray<T>::NDarray(std::vector<size_t> dims, T value) : shape(dims)
+void NDarray<T>::update_layout()
 {
-    size_t tsize = 1;             // Calcule la taille totale
-    strides.resize(shape.size()); // Redimensionne le vecteur des pas
+    total_size = 1;
+    for (size_t d : shape)
+        total_size *= d;
+    c_order = true;
+    long long expected = 1;
     for (size_t i = shape.size(); i > 0; --i)
     {
-        strides[i - 1] = tsize; // Calcule les pas pour chaque dimension
-        tsize *= shape[i - 1];  // Met à jour la taille totale
+        // Les dimensions de taille 1 n'influencent pas la disposition mémoire
+        if (shape[i - 1] != 1 && strides[i - 1] != expected)
+            c_order = false;
+        expected *= static_cast<long long>(shape[i - 1]);
     }
-    data.resize(tsize, value); // Initialise les données avec la valeur donnée
+    if (total_size == 0)
+        c_order = true;
+}
+
+// Position dans le tampon de l'élément d'index plat (ordre C) donné
+template <typename T>
+size_t NDarray<T>::offset_of(size_t flat_index) const
+{
+    long long pos = static_cast<long long>(offset);
+    for (size_t i = shape.size(); i > 0; --i)
+    {
+        pos += static_cast<long long>(flat_index % shape[i - 1]) * strides[i - 1];
+        flat_index /= shape[i - 1];
+    }
+    return static_cast<size_t>(pos);
+}
+
+// Copie les éléments dans l'ordre C vers dst (en parallèle pour les grands tableaux)
+template <typename T>
+void NDarray<T>::copy_to(T *dst) const
+{
+    NDARRAY_TIMED("copy");
+    NDARRAY_COUNT_COPY(total_size * sizeof(T));
+    if (c_order)
+    {
+        const T *src = data();
+        nd::parallel_for_elements(total_size, 1, [&](size_t lo, size_t hi)
+                                  { std::copy(src + lo, src + hi, dst + lo); }); // Copie en bloc
+        return;
+    }
+    if (total_size == 0)
+        return;
+    // Parcours « odomètre » des dimensions externes, boucle interne sur le dernier axe
+    size_t ndim = shape.size();
+    size_t inner = shape[ndim - 1];
+    long long inner_stride = strides[ndim - 1];
+    const T *base = storage.get();
+    nd::parallel_for_elements(total_size / inner, inner, [&](size_t lo, size_t hi)
+                              {
+        // Position de la première ligne du bloc
+        std::vector<size_t> counters(ndim - 1, 0);
+        long long pos = static_cast<long long>(offset);
+        for (size_t i = ndim - 1, r = lo; i > 0; --i)
+        {
+            counters[i - 1] = r % shape[i - 1];
+            r /= shape[i - 1];
+            pos += static_cast<long long>(counters[i - 1]) * strides[i - 1];
+        }
+        T *out = dst + lo * inner;
+        for (size_t r = lo; r < hi; ++r)
+        {
+            const T *src = base + pos;
+            for (size_t j = 0; j < inner; ++j)
+                *out++ = src[static_cast<long long>(j) * inner_stride];
+            // Incrémentation multi-dimensionnelle en mettant à jour la position incrémentalement
+            for (size_t i = ndim - 1; i > 0; --i)
+            {
+                pos += strides[i - 1];
+                if (++counters[i - 1] < shape[i - 1])
+                    break;
+                pos -= strides[i - 1] * static_cast<long long>(shape[i - 1]);
+                counters[i - 1] = 0;
+            }
+        } });
 }
 
 // Retourne la taille totale du tableau
 template <typename T>
 size_t NDarray<T>::getSize() const
 {
-    return data.size();
+    return total_size;
 }
 
-// Calcule l'index plat à partir d'une liste d'indices multi-dimensionnels
+// Calcule la position dans le tampon à partir d'une liste d'indices multi-dimensionnels
 template <typename T>
-size_t NDarray<T>::get_flat_index(const std::vector<size_t> &indices) const
+size_t NDarray<T>::get_flat_index(std::initializer_list<size_t> indices) const
 {
     if (indices.size() != shape.size())
     {
         throw std::out_of_range("Le nombre d'indices ne correspond pas aux dimensions du tableau");
     }
-    size_t index = 0;
-    for (size_t i = 0; i < indices.size(); ++i)
+    long long index = static_cast<long long>(offset);
+    size_t i = 0;
+    for (size_t idx : indices)
     {
-        if (indices[i] >= shape[i])
+        if (idx >= shape[i])
         {
             throw std::out_of_range("Index hors des limites");
         }
-        index += indices[i] * strides[i]; // Calcule l'index plat en utilisant les pas
+        index += static_cast<long long>(idx) * strides[i]; // Calcule la position en utilisant les pas
+        ++i;
     }
-    return index;
+    return static_cast<size_t>(index);
 }
 
 // Normalise une tranche pour gérer les indices négatifs et vérifier les bornes
@@ -97,25 +285,25 @@ void NDarray<T>::print() const
     std::cout << "array(";
     if (shape.empty())
     {
-        std::cout << data[0]; // Cas d'un tableau scalaire
+        std::cout << storage[offset]; // Cas d'un tableau scalaire
     }
     else
     {
-        print_recursive(0, 0); // Appelle la méthode récursive pour l'affichage
+        print_recursive(0, static_cast<long long>(offset)); // Appelle la méthode récursive pour l'affichage
     }
     std::cout << ")" << std::endl;
 }
 
 // Affiche récursivement les tableaux multi-dimensionnels
 template <typename T>
-void NDarray<T>::print_recursive(size_t dim, size_t start_idx, int indent) const
+void NDarray<T>::print_recursive(size_t dim, long long start_idx, int indent) const
 {
     if (dim == shape.size() - 1)
     {
         std::cout << "["; // Début d'une ligne
         for (size_t i = 0; i < shape[dim]; ++i)
         {
-            std::cout << data[start_idx + i * strides[dim]]; // Affiche chaque élément
+            std::cout << storage[start_idx + static_cast<long long>(i) * strides[dim]]; // Affiche chaque élément
             if (i < shape[dim] - 1)
                 std::cout << ", "; // Ajoute une virgule entre les éléments
         }
@@ -126,7 +314,7 @@ void NDarray<T>::print_recursive(size_t dim, size_t start_idx, int indent) const
         std::cout << "[\n"; // Début d'un tableau imbriqué
         for (size_t i = 0; i < shape[dim]; ++i)
         {
-            print_recursive(dim + 1, start_idx + i * strides[dim], indent + 2); // Appel récursif
+            print_recursive(dim + 1, start_idx + static_cast<long long>(i) * strides[dim], indent + 2); // Appel récursif
             if (i < shape[dim] - 1)
                 std::cout << "\n"; // Saut de ligne entre sous-tableaux
         }
@@ -138,22 +326,21 @@ void NDarray<T>::print_recursive(size_t dim, size_t start_idx, int indent) const
 template <typename T>
 T &NDarray<T>::at(std::initializer_list<size_t> indices)
 {
-    std::vector<size_t> idx_vec(indices.begin(), indices.end());
-    return data[get_flat_index(idx_vec)]; // Retourne une référence à l'élément
+    return storage[get_flat_index(indices)]; // Retourne une référence à l'élément
 }
 
 // Accède à un élément spécifique (version constante)
 template <typename T>
 const T &NDarray<T>::at(std::initializer_list<size_t> indices) const
 {
-    std::vector<size_t> idx_vec(indices.begin(), indices.end());
-    return data[get_flat_index(idx_vec)]; // Retourne une référence constante à l'élément
+    return storage[get_flat_index(indices)]; // Retourne une référence constante à l'élément
 }
 
 // Extrait une sous-partie du tableau via des tranches
 template <typename T>
 NDarray<T> NDarray<T>::operator[](const std::vector<Slice> &slices) const
 {
+    NDARRAY_TIMED("slice");
     if (slices.size() > shape.size())
         throw std::out_of_range("Trop de tranches pour les dimensions du tableau");
 
@@ -191,35 +378,22 @@ NDarray<T> NDarray<T>::operator[](const std::vector<Slice> &slices) const
         new_shape.push_back(shape[i]);
     }
 
-    NDarray<T> result(new_shape);                      // Crée le tableau résultant
-    std::vector<size_t> counters(new_shape.size(), 0); // Compteurs pour l'itération
-    bool done = false;
-    while (!done)
+    // Construit la vue : chaque tranche décale l'origine et multiplie le pas de son axe
+    long long new_offset = static_cast<long long>(offset);
+    std::vector<long long> new_strides(shape.size());
+    bool empty = false;
+    for (size_t i = 0; i < shape.size(); ++i)
     {
-        std::vector<size_t> src_indices;
-        for (size_t i = 0; i < counters.size(); ++i)
-        {
-            long long val = norm_slices[i].start + counters[i] * norm_slices[i].step; // Calcule l'index source
-            if (val < 0 || val >= static_cast<long long>(shape[i]))
-                throw std::out_of_range("Index calculé hors des limites pendant le slicing : val=" + std::to_string(val));
-            src_indices.push_back(static_cast<size_t>(val));
-        }
-
-        result.data[result.get_flat_index(counters)] = data[get_flat_index(src_indices)]; // Copie la valeur
-
-        // Incrémentation multi-dimensionnelle
-        for (int i = counters.size() - 1; i >= 0; --i)
-        {
-            counters[i]++;
-            if (counters[i] < new_shape[i])
-                break;
-            counters[i] = 0;
-            if (i == 0)
-                done = true;
-        }
+        if (new_shape[i] == 0)
+            empty = true;
+        new_strides[i] = strides[i] * norm_slices[i].step;
     }
-
-    return result;
+    if (!empty)
+    {
+        for (size_t i = 0; i < shape.size(); ++i)
+            new_offset += norm_slices[i].start * strides[i];
+    }
+    return NDarray<T>(storage, static_cast<size_t>(new_offset), new_shape, new_strides);
 }
 template <typename T>
 NDarray<T> NDarray<T>::zeros(std::initializer_list<size_t> dims)
@@ -252,16 +426,18 @@ NDarray<T> NDarray<T>::eye(size_t n)
 template <typename T>
 NDarray<T> NDarray<T>::arange(T start, T stop, T step)
 {
+    NDARRAY_TIMED("arange");
     if (step == 0)
         throw std::invalid_argument("Le pas ne peut pas être zéro");
     size_t size = static_cast<size_t>((stop - start) / step);
     if ((stop - start) * step < 0)
         size = 0; // Ajuste la taille si la plage est vide
     NDarray<T> arr({size});
-    for (size_t i = 0; i < size; ++i)
-    {
-        arr.data[i] = start + i * step; // Remplit avec la séquence
-    }
+    T *p = arr.data();
+    nd::parallel_for_elements(size, 1, [&](size_t lo, size_t hi)
+                              {
+        for (size_t i = lo; i < hi; ++i)
+            p[i] = start + i * step; }); // Remplit avec la séquence
     return arr;
 }
 
@@ -269,44 +445,35 @@ NDarray<T> NDarray<T>::arange(T start, T stop, T step)
 template <typename T>
 NDarray<T> NDarray<T>::linspace(T start, T stop, size_t num)
 {
+    NDARRAY_TIMED("linspace");
     if (num == 0)
         throw std::invalid_argument("Le nombre d'échantillons doit être positif");
     if (num == 1)
         return NDarray<T>({1}, start);
     NDarray<T> arr({num});
     T step = (stop - start) / (num - 1); // Calcule le pas
-    for (size_t i = 0; i < num; ++i)
-    {
-        arr.data[i] = start + i * step; // Remplit avec les valeurs
-    }
+    T *p = arr.data();
+    nd::parallel_for_elements(num, 1, [&](size_t lo, size_t hi)
+                              {
+        for (size_t i = lo; i < hi; ++i)
+            p[i] = start + i * step; }); // Remplit avec les valeurs
     return arr;
 }
 
-// Crée un tableau avec des valeurs aléatoires
+// Crée un tableau avec des valeurs aléatoires : réels dans [min_val, max_val), entiers dans [min_val, max_val].
+// Les tirages viennent du générateur partagé nd::default_generator() (reproductible avec nd::seed).
 template <typename T>
 NDarray<T> NDarray<T>::rand(std::initializer_list<size_t> dims, T min_val, T max_val)
 {
     static_assert(std::is_integral<T>::value || std::is_floating_point<T>::value,
                   "T doit être un type entier ou à virgule flottante");
-    NDarray<T> result(dims);
-    static std::random_device rd;
-    static std::mt19937 gen(rd()); // Générateur aléatoire
+    if (min_val > max_val)
+        throw std::invalid_argument("min_val doit être inférieur ou égal à max_val");
+    NDarray<T> result = uninitialized(dims);
     if constexpr (std::is_integral<T>::value)
-    {
-        std::uniform_int_distribution<T> dist(min_val, max_val);
-        for (size_t i = 0; i < result.getSize(); ++i)
-        {
-            result.data[i] = dist(gen); // Remplit avec des entiers aléatoires
-        }
-    }
-    else if constexpr (std::is_floating_point<T>::value)
-    {
-        std::uniform_real_distribution<T> dist(min_val, max_val);
-        for (size_t i = 0; i < result.getSize(); ++i)
-        {
-            result.data[i] = dist(gen); // Remplit avec des flottants aléatoires
-        }
-    }
+        nd::default_generator().fill_range(result, min_val, nd::detail::to_u64(max_val) - nd::detail::to_u64(min_val) + 1); // Entiers aléatoires, bornes incluses
+    else
+        nd::default_generator().fill_uniform(result, min_val, max_val); // Flottants aléatoires
     return result;
 }
 
@@ -315,17 +482,92 @@ template <typename T>
 NDarray<T> NDarray<T>::randint(T low, T high, std::initializer_list<size_t> dims)
 {
     static_assert(std::is_integral<T>::value, "randint ne supporte que les types entiers");
-    if (low >= high)
-        throw std::invalid_argument("low doit être inférieur à high");
-    NDarray<T> result(dims);
-    static std::random_device rd;
-    static std::mt19937 gen(rd());                        // Générateur aléatoire
-    std::uniform_int_distribution<T> dist(low, high - 1); // high exclusif
-    for (size_t i = 0; i < result.getSize(); ++i)
+    NDarray<T> result = uninitialized(dims);
+    nd::default_generator().fill_integers(result, low, high); // high exclusif
+    return result;
+}
+
+// Crée un tableau de tirages de la loi normale
+template <typename T>
+NDarray<T> NDarray<T>::randn(std::initializer_list<size_t> dims, T mean, T stddev)
+{
+    static_assert(std::is_floating_point<T>::value, "randn ne supporte que les types à virgule flottante");
+    NDarray<T> result = uninitialized(dims);
+    nd::default_generator().fill_normal(result, mean, stddev);
+    return result;
+}
+
+// Charge un fichier .npy
+template <typename T>
+NDarray<T> NDarray<T>::load(const std::string &path, nd::LoadMode mode)
+{
+    return load_npy(path, 0, mode);
+}
+
+// Charge le tableau name d'une archive .npz
+template <typename T>
+NDarray<T> NDarray<T>::load(const std::string &path, const std::string &name, nd::LoadMode mode)
+{
+    return load_npy(path, nd::detail::npz_member_pos(path, name), mode);
+}
+
+template <typename T>
+NDarray<T> NDarray<T>::load_npy(const std::string &path, uint64_t pos, nd::LoadMode mode)
+{
+    NDARRAY_TIMED("load");
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("Impossible d'ouvrir le fichier " + path);
+    in.seekg(static_cast<std::streamoff>(pos));
+    nd::detail::NpyHeader header = nd::detail::read_npy_header(in);
+    bool swap = nd::detail::check_npy_descr<T>(header.descr);
+    size_t n = 1;
+    for (size_t d : header.shape)
+        n *= d;
+    uint64_t nbytes = static_cast<uint64_t>(n) * sizeof(T);
+    in.seekg(0, std::ios::end);
+    if (static_cast<uint64_t>(in.tellg()) < header.data_pos + nbytes)
+        throw std::runtime_error("Fichier .npy tronqué : " + path);
+
+    // Pas des données : ordre C, ou ordre Fortran (premier axe contigu)
+    std::vector<long long> steps(header.shape.size());
+    long long step = 1;
+    for (size_t k = 0; k < steps.size(); ++k)
     {
-        result.data[i] = dist(gen); // Remplit avec des entiers aléatoires
+        size_t d = header.fortran_order ? k : steps.size() - 1 - k;
+        steps[d] = step;
+        step *= static_cast<long long>(header.shape[d]);
     }
-    return result;
+
+    std::shared_ptr<T[]> buffer;
+    if (mode == nd::LoadMode::copy || n == 0)
+    {
+        buffer = allocate(n);
+        in.seekg(static_cast<std::streamoff>(header.data_pos));
+        if (!in.read(reinterpret_cast<char *>(buffer.get()), static_cast<std::streamsize>(nbytes)))
+            throw std::runtime_error("Erreur de lecture du fichier " + path);
+        if (swap)
+            nd::detail::byteswap(buffer.get(), n, sizeof(T));
+    }
+    else
+    {
+        if (swap)
+            throw std::runtime_error("Ordre des octets du fichier différent de celui de la machine : projection impossible, charger par copie");
+        if (header.data_pos % alignof(T) != 0)
+            throw std::runtime_error("Données mal alignées dans le fichier : projection impossible, charger par copie");
+        buffer = nd::detail::map_file<T>(path, header.data_pos, nbytes, mode == nd::LoadMode::map_shared);
+    }
+    return NDarray<T>(std::move(buffer), 0, header.shape, steps);
+}
+
+// Enregistre le tableau au format .npy
+template <typename T>
+void NDarray<T>::save(const std::string &path) const
+{
+    NDARRAY_TIMED("save");
+    nd::NpyWriter<T> writer(path, shape);
+    writer.write(*this);
+    writer.close();
 }
 
 // Reformate le tableau à une nouvelle forme
@@ -341,22 +583,84 @@ void NDarray<T>::reshape(std::initializer_list<size_t> new_shape)
     {
         throw std::runtime_error("La nouvelle forme est incompatible avec la taille actuelle");
     }
+    if (!c_order)
+    {
+        *this = copy(); // Une vue non contiguë doit être matérialisée avant de changer de forme
+    }
     shape = new_shape;
-    strides.resize(shape.size());
-    size_t tsize = 1;
-    for (size_t i = shape.size(); i > 0; --i)
+    set_contiguous_strides(); // Recalcule les pas
+}
+
+// Renvoie le tableau avec une nouvelle forme (vue si le tableau est contigu)
+template <typename T>
+NDarray<T> NDarray<T>::reshaped(std::vector<size_t> new_shape) const
+{
+    size_t new_size = 1;
+    for (size_t d : new_shape)
+    {
+        new_size *= d;
+    }
+    if (new_size != getSize())
     {
-        strides[i - 1] = tsize; // Recalcule les pas
-        tsize *= shape[i - 1];
+        throw std::runtime_error("La nouvelle forme est incompatible avec la taille actuelle");
     }
+    NDarray<T> result = contiguous(); // Vue si possible, copie sinon
+    result.shape = std::move(new_shape);
+    result.set_contiguous_strides();
+    return result;
+}
+
+// Inverse l'ordre des axes
+template <typename T>
+NDarray<T> NDarray<T>::transpose() const
+{
+    return NDarray<T>(storage, offset,
+                      std::vector<size_t>(shape.rbegin(), shape.rend()),
+                      std::vector<long long>(strides.rbegin(), strides.rend()));
+}
+
+// Permute les axes selon l'ordre donné
+template <typename T>
+NDarray<T> NDarray<T>::transpose(const std::vector<size_t> &axes) const
+{
+    if (axes.size() != shape.size())
+        throw std::invalid_argument("Le nombre d'axes ne correspond pas aux dimensions du tableau");
+    std::vector<bool> seen(shape.size(), false);
+    std::vector<size_t> new_shape(shape.size());
+    std::vector<long long> new_strides(shape.size());
+    for (size_t i = 0; i < axes.size(); ++i)
+    {
+        if (axes[i] >= shape.size() || seen[axes[i]])
+            throw std::invalid_argument("Permutation d'axes invalide");
+        seen[axes[i]] = true;
+        new_shape[i] = shape[axes[i]];
+        new_strides[i] = strides[axes[i]];
+    }
+    return NDarray<T>(storage, offset, new_shape, new_strides);
+}
+
+// Matérialise le tableau dans un nouveau tampon contigu
+template <typename T>
+NDarray<T> NDarray<T>::copy() const
+{
+    return NDarray<T>(*this);
+}
+
+// Renvoie une vue si le tableau est déjà contigu, une copie sinon
+template <typename T>
+NDarray<T> NDarray<T>::contiguous() const
+{
+    if (c_order)
+        return NDarray<T>(storage, offset, shape, strides);
+    return copy();
 }
 
 // Aplatit le tableau en un tableau 1D
 template <typename T>
 NDarray<T> NDarray<T>::flatten() const
 {
-    NDarray<T> flat({getSize()});
-    flat.data = data; // Copie les données
+    NDarray<T> flat = uninitialized({getSize()});
+    copy_to(flat.storage.get()); // Copie les données
     return flat;
 }
 
@@ -364,234 +668,672 @@ NDarray<T> NDarray<T>::flatten() const
 template <typename T>
 NDarray<T> NDarray<T>::concatenate(const NDarray<T> &other, size_t axis)
 {
-    if (shape.size() != other.shape.size())
+    return concatenate({*this, other}, axis);
+}
+
+/*
+ * Concatène des tableaux le long d'un axe. Le résultat est vu comme outer lignes (produit des
+ * dimensions avant axis), chacune formée d'un bloc contigu de chaque entrée. Le tableau de sortie est
+ * parcouru à plat par plages réparties entre les threads : chaque plage copie en bloc les morceaux
+ * d'entrées contiguës qu'elle recouvre. Les entrées non contiguës (vues) sont écrites directement
+ * dans la partie correspondante du résultat, sans copie intermédiaire.
+ */
+template <typename T>
+NDarray<T> NDarray<T>::concatenate_all(const std::vector<const NDarray<T> *> &arrays, size_t axis)
+{
+    NDARRAY_TIMED("concatenate");
+    if (arrays.empty())
+        throw std::invalid_argument("Aucun tableau à concaténer");
+    const NDarray<T> &first = *arrays[0];
+    size_t ndim = first.shape.size();
+    if (axis >= ndim)
+        throw std::out_of_range("Axe de concaténation hors des limites");
+    std::vector<size_t> out_shape = first.shape;
+    out_shape[axis] = 0;
+    for (const NDarray<T> *p : arrays)
     {
-        throw std::runtime_error("Les tableaux doivent avoir le même nombre de dimensions");
+        const NDarray<T> &a = *p;
+        if (a.shape.size() != ndim)
+            throw std::runtime_error("Les tableaux doivent avoir le même nombre de dimensions");
+        for (size_t d = 0; d < ndim; ++d)
+            if (d != axis && a.shape[d] != first.shape[d])
+                throw std::runtime_error("Formes incompatibles le long de l'axe non concaténé");
+        out_shape[axis] += a.shape[axis]; // Ajuste la dimension de l'axe
     }
-    for (size_t i = 0; i < shape.size(); ++i)
+    NDarray<T> result = uninitialized(out_shape);
+    size_t outer = 1, tail = 1;
+    for (size_t d = 0; d < axis; ++d)
+        outer *= out_shape[d];
+    for (size_t d = axis + 1; d < ndim; ++d)
+        tail *= out_shape[d];
+
+    // Position de chaque entrée dans une ligne du résultat
+    size_t k = arrays.size();
+    std::vector<size_t> start(k + 1, 0);
+    std::vector<const T *> src(k, nullptr); // nullptr : entrée non contiguë
+    for (size_t i = 0; i < k; ++i)
     {
-        if (i != axis && shape[i] != other.shape[i])
+        const NDarray<T> &a = *arrays[i];
+        start[i + 1] = start[i] + a.shape[axis] * tail;
+        if (a.c_order)
+            src[i] = a.data();
+        else if (a.total_size > 0)
         {
-            throw std::runtime_error("Formes incompatibles le long de l'axe non concaténé");
+            NDarray<T> part(result.storage, start[i], a.shape, result.strides); // Partie du résultat occupée par a
+            nd::detail::evaluate(nd::detail::wrap(a), part);
         }
     }
-    std::vector<size_t> new_shape = shape;
-    new_shape[axis] += other.shape[axis]; // Ajuste la dimension de l'axe
-    NDarray<T> result(new_shape);
-    size_t offset = 0;
-    for (size_t i = 0; i < data.size(); ++i)
+    size_t row = start[k];
+    T *out = result.data();
+    nd::parallel_for_elements(outer * row, 1, [&](size_t lo, size_t hi)
+                              {
+        size_t o = lo / row, p = lo % row, i = 0;
+        while (lo < hi)
+        {
+            while (p >= start[i + 1])
+                ++i;
+            size_t len = std::min(start[i + 1] - p, hi - lo);
+            if (src[i])
+                std::copy(src[i] + o * (start[i + 1] - start[i]) + (p - start[i]),
+                          src[i] + o * (start[i + 1] - start[i]) + (p - start[i]) + len, out + lo); // Copie en bloc
+            lo += len;
+            p += len;
+            if (p == row)
+            {
+                p = 0;
+                i = 0;
+                ++o;
+            }
+        } });
+    NDARRAY_COUNT_COPY(result.total_size * sizeof(T));
+    return result;
+}
+
+// Empile des tableaux de même forme le long d'un nouvel axe
+template <typename T>
+NDarray<T> NDarray<T>::stack_all(const std::vector<const NDarray<T> *> &arrays, size_t axis)
+{
+    if (arrays.empty())
+        throw std::invalid_argument("Aucun tableau à empiler");
+    const NDarray<T> &first = *arrays[0];
+    if (axis > first.shape.size())
+        throw std::out_of_range("Axe d'empilement hors des limites");
+    // Chaque entrée devient une vue avec un axe de taille 1 inséré (aucune copie)
+    std::vector<NDarray<T>> views;
+    views.reserve(arrays.size());
+    for (const NDarray<T> *p : arrays)
     {
-        result.data[offset++] = data[i]; // Copie les données du premier tableau
+        const NDarray<T> &a = *p;
+        if (a.shape != first.shape)
+            throw std::runtime_error("Les tableaux doivent avoir la même forme pour stack");
+        std::vector<size_t> dims = a.shape;
+        std::vector<long long> steps = a.strides;
+        dims.insert(dims.begin() + axis, 1);
+        steps.insert(steps.begin() + axis, 0);
+        views.push_back(NDarray<T>(a.storage, a.offset, dims, steps));
     }
-    for (size_t i = 0; i < other.data.size(); ++i)
+    return concatenate(views, axis);
+}
+
+// Concatène des tableaux horizontalement (axe 0 pour des tableaux 1D, axe 1 sinon)
+template <typename T>
+NDarray<T> NDarray<T>::hstack_all(const std::vector<const NDarray<T> *> &arrays)
+{
+    if (arrays.empty())
+        throw std::invalid_argument("Aucun tableau à concaténer");
+    const NDarray<T> &first = *arrays[0];
+    if (first.shape.size() == 1)
+        return concatenate_all(arrays, 0); // Cas 1D
+    for (const NDarray<T> *a : arrays)
+        if (a->shape.size() < 2 || a->shape[0] != first.shape[0])
+            throw std::runtime_error("Les tableaux doivent avoir le même nombre de lignes pour hstack");
+    return concatenate_all(arrays, 1); // Concaténation le long de l'axe 1
+}
+
+// Concatène des tableaux verticalement ; un tableau 1D est vu comme une ligne, sans copie
+template <typename T>
+NDarray<T> NDarray<T>::vstack_all(const std::vector<const NDarray<T> *> &arrays)
+{
+    if (arrays.empty())
+        throw std::invalid_argument("Aucun tableau à concaténer");
+    std::vector<NDarray<T>> rows;
+    rows.reserve(arrays.size());
+    for (const NDarray<T> *p : arrays)
     {
-        result.data[offset++] = other.data[i]; // Copie les données du second tableau
+        const NDarray<T> &a = *p;
+        if (a.shape.size() == 1)
+            rows.push_back(NDarray<T>(a.storage, a.offset, {1, a.shape[0]}, {0, a.strides[0]})); // Convertit 1D en 2D
+        else
+            rows.push_back(NDarray<T>(a.storage, a.offset, a.shape, a.strides));
+        if (rows.back().shape.size() < 2 || rows.back().shape[1] != rows.front().shape[1])
+            throw std::runtime_error("Les tableaux doivent avoir le même nombre de colonnes pour vstack");
     }
-    return result;
+    return concatenate(rows, 0); // Concaténation le long de l'axe 0
+}
+
+// Listes {a, b, ...} (références, temporaires acceptés) et vecteurs de tableaux
+template <typename T>
+std::vector<const NDarray<T> *> NDarray<T>::pointers(std::initializer_list<Input> arrays)
+{
+    std::vector<const NDarray<T> *> ptrs;
+    ptrs.reserve(arrays.size());
+    for (const Input &a : arrays)
+        ptrs.push_back(a.get());
+    return ptrs;
+}
+
+template <typename T>
+std::vector<const NDarray<T> *> NDarray<T>::pointers(const std::vector<NDarray<T>> &arrays)
+{
+    std::vector<const NDarray<T> *> ptrs;
+    ptrs.reserve(arrays.size());
+    for (const NDarray<T> &a : arrays)
+        ptrs.push_back(&a);
+    return ptrs;
 }
 
+template <typename T>
+NDarray<T> NDarray<T>::concatenate(std::initializer_list<Input> arrays, size_t axis) { return concatenate_all(pointers(arrays), axis); }
+template <typename T>
+NDarray<T> NDarray<T>::concatenate(const std::vector<NDarray<T>> &arrays, size_t axis) { return concatenate_all(pointers(arrays), axis); }
+template <typename T>
+NDarray<T> NDarray<T>::stack(std::initializer_list<Input> arrays, size_t axis) { return stack_all(pointers(arrays), axis); }
+template <typename T>
+NDarray<T> NDarray<T>::stack(const std::vector<NDarray<T>> &arrays, size_t axis) { return stack_all(pointers(arrays), axis); }
+template <typename T>
+NDarray<T> NDarray<T>::hstack(std::initializer_list<Input> arrays) { return hstack_all(pointers(arrays)); }
+template <typename T>
+NDarray<T> NDarray<T>::hstack(const std::vector<NDarray<T>> &arrays) { return hstack_all(pointers(arrays)); }
+template <typename T>
+NDarray<T> NDarray<T>::vstack(std::initializer_list<Input> arrays) { return vstack_all(pointers(arrays)); }
+template <typename T>
+NDarray<T> NDarray<T>::vstack(const std::vector<NDarray<T>> &arrays) { return vstack_all(pointers(arrays)); }
+
 // Concatène deux tableaux horizontalement
 template <typename T>
 NDarray<T> NDarray<T>::hstack(const NDarray<T> &other)
 {
-    std::vector<size_t> shape1 = shape;
-    std::vector<size_t> shape2 = other.shape;
-    if (shape1.size() == 1 && shape2.size() == 1)
-    {
-        return concatenate(other, 0); // Cas 1D
-    }
-    if (shape1[0] != shape2[0])
-    {
-        throw std::runtime_error("Les tableaux doivent avoir le même nombre de lignes pour hstack");
-    }
-    return concatenate(other, 1); // Concaténation le long de l'axe 1
+    return hstack({*this, other});
 }
 
 // Concatène deux tableaux verticalement
 template <typename T>
 NDarray<T> NDarray<T>::vstack(const NDarray<T> &other)
 {
-    NDarray<T> arr1_2d = *this;
-    NDarray<T> arr2_2d = other;
-    if (shape.size() == 1)
+    return vstack({*this, other});
+}
+
+// Opérateurs composés : l'expression est évaluée directement dans le tableau
+template <typename T>
+template <typename B, typename>
+NDarray<T> &NDarray<T>::operator+=(B &&rhs)
+{
+    nd::detail::compound<nd::detail::AddOp>(*this, std::forward<B>(rhs));
+    return *this;
+}
+
+template <typename T>
+template <typename B, typename>
+NDarray<T> &NDarray<T>::operator-=(B &&rhs)
+{
+    nd::detail::compound<nd::detail::SubOp>(*this, std::forward<B>(rhs));
+    return *this;
+}
+
+template <typename T>
+template <typename B, typename>
+NDarray<T> &NDarray<T>::operator*=(B &&rhs)
+{
+    nd::detail::compound<nd::detail::MulOp>(*this, std::forward<B>(rhs));
+    return *this;
+}
+
+template <typename T>
+template <typename B, typename>
+NDarray<T> &NDarray<T>::operator/=(B &&rhs)
+{
+    nd::detail::compound<nd::detail::DivOp>(*this, std::forward<B>(rhs));
+    return *this;
+}
+
+// Additionne deux tableaux (version fonctionnelle)
+template <typename T>
+NDarray<T> NDarray<T>::add(const NDarray<T> &a, const NDarray<T> &b)
+{
+    return a + b;
+}
+
+// Soustrait deux tableaux (version fonctionnelle)
+template <typename T>
+NDarray<T> NDarray<T>::subtract(const NDarray<T> &a, const NDarray<T> &b)
+{
+    return a - b;
+}
+
+// Multiplie deux tableaux (version fonctionnelle)
+template <typename T>
+NDarray<T> NDarray<T>::multiply(const NDarray<T> &a, const NDarray<T> &b)
+{
+    return a * b;
+}
+
+// Divise deux tableaux (version fonctionnelle)
+template <typename T>
+NDarray<T> NDarray<T>::divide(const NDarray<T> &a, const NDarray<T> &b)
+{
+    return a / b;
+}
+
+// Effectue un produit matriciel (règle de numpy.dot au-delà de deux dimensions)
+template <typename T>
+NDarray<T> NDarray<T>::dot(const NDarray<T> &a, const NDarray<T> &b)
+{
+    NDARRAY_TIMED("dot");
+    if (a.shape.empty() || b.shape.empty())
+        throw std::invalid_argument("Le produit matriciel n'est pas défini pour les tableaux 0D");
+    if (a.shape.size() > 2 || b.shape.size() > 2)
+        return dot_nd(a, b);
+
+    size_t ka = a.shape.back();
+    size_t kb = b.shape[0];
+    if (ka != kb)
+        throw std::invalid_argument("Les dimensions internes doivent correspondre pour le produit matriciel");
+
+    if (a.shape.size() == 1 && b.shape.size() == 1)
     {
-        arr1_2d.reshape({1, shape[0]}); // Convertit 1D en 2D
+        // Produit scalaire : traité comme une matrice 1 x k par un vecteur
+        NDarray<T> result(std::vector<size_t>{}, 0);
+        nd::detail::gemv<T>(1, ka, a.data(), 0, a.strides[0], b.data(), b.strides[0], result.data());
+        return result;
     }
-    if (other.shape.size() == 1)
+    if (b.shape.size() == 1)
     {
-        arr2_2d.reshape({1, other.shape[0]}); // Convertit 1D en 2D
+        // Matrice-vecteur
+        NDarray<T> result({a.shape[0]}, 0);
+        nd::detail::gemv<T>(a.shape[0], ka, a.data(), a.strides[0], a.strides[1], b.data(), b.strides[0], result.data());
+        return result;
     }
-    if (arr1_2d.shape[1] != arr2_2d.shape[1])
+    if (a.shape.size() == 1)
     {
-        throw std::runtime_error("Les tableaux doivent avoir le même nombre de colonnes pour vstack");
+        // Vecteur-matrice : x·B = (B^T)·x
+        NDarray<T> result({b.shape[1]}, 0);
+        nd::detail::gemv<T>(b.shape[1], ka, b.data(), b.strides[1], b.strides[0], a.data(), a.strides[0], result.data());
+        return result;
     }
-    return arr1_2d.concatenate(arr2_2d, 0); // Concaténation le long de l'axe 0
+
+    NDarray<T> result({a.shape[0], b.shape[1]}, 0);
+    nd::detail::gemm<T>(a.shape[0], b.shape[1], ka,
+                        a.data(), a.strides[0], a.strides[1],
+                        b.data(), b.strides[0], b.strides[1],
+                        result.data(), b.shape[1]);
+    return result;
 }
 
-// Additionne deux tableaux élément par élément
+// numpy.dot au-delà de deux dimensions : un produit de matrices m x k par k x n pour chaque couple
+// (lot de a, lot de b), écrit directement à sa place dans le résultat (lignes de pas ldc)
 template <typename T>
-NDarray<T> NDarray<T>::operator+(const NDarray<T> &other) const
+NDarray<T> NDarray<T>::dot_nd(const NDarray<T> &a, const NDarray<T> &b)
 {
-    if (shape != other.shape)
+    size_t na = a.shape.size(), nb = b.shape.size();
+    size_t kb_axis = nb >= 2 ? nb - 2 : 0; // Axe de b contracté
+    size_t k = a.shape.back();
+    if (b.shape[kb_axis] != k)
+        throw std::invalid_argument("Les dimensions internes doivent correspondre pour le produit matriciel");
+    size_t m = na >= 2 ? a.shape[na - 2] : 1, n = nb >= 2 ? b.shape.back() : 1;
+    long long rsa = na >= 2 ? a.strides[na - 2] : 0, csa = a.strides.back();
+    long long rsb = b.strides[kb_axis], csb = nb >= 2 ? b.strides.back() : 0;
+    size_t lead_a = na >= 2 ? na - 2 : 0, lead_b = kb_axis;
+
+    std::vector<size_t> out_shape(a.shape.begin(), a.shape.end() - 1);
+    out_shape.insert(out_shape.end(), b.shape.begin(), b.shape.begin() + lead_b);
+    if (nb >= 2)
+        out_shape.push_back(n);
+    NDarray<T> result(out_shape, 0);
+
+    size_t nbatch_a = 1, nbatch_b = 1;
+    for (size_t i = 0; i < lead_a; ++i)
+        nbatch_a *= a.shape[i];
+    for (size_t i = 0; i < lead_b; ++i)
+        nbatch_b *= b.shape[i];
+    size_t ldc = nbatch_b * n;
+    // Position du lot t parmi les premiers axes d'un opérande
+    auto batch_offset = [](const NDarray<T> &x, size_t lead, size_t t)
     {
-        throw std::invalid_argument("Les formes doivent correspondre pour l'addition");
-    }
-    NDarray<T> result(shape);
-    for (size_t i = 0; i < data.size(); ++i)
+        long long off = 0;
+        for (size_t i = lead; i > 0; --i)
+        {
+            off += static_cast<long long>(t % x.shape[i - 1]) * x.strides[i - 1];
+            t /= x.shape[i - 1];
+        }
+        return off;
+    };
+    const T *pa = a.data(), *pb = b.data();
+    T *pr = result.data();
+    size_t nbatch = nbatch_a * nbatch_b;
+    bool per_batch = nbatch >= nd::num_threads() && m * n * k < 64 * 64 * 64;
+    auto run = [&](size_t lo, size_t hi)
     {
-        result.data[i] = data[i] + other.data[i];
-    }
+        for (size_t t = lo; t < hi; ++t)
+        {
+            size_t ia = t / nbatch_b, ib = t % nbatch_b;
+            nd::detail::gemm<T>(m, n, k, pa + batch_offset(a, lead_a, ia), rsa, csa,
+                                pb + batch_offset(b, lead_b, ib), rsb, csb,
+                                pr + ia * m * ldc + ib * n, ldc, !per_batch);
+        }
+    };
+    if (per_batch)
+        nd::parallel_for(0, nbatch, 1, run);
+    else
+        run(0, nbatch);
     return result;
 }
 
-// Soustrait deux tableaux élément par élément
+// Produit matriciel par lots avec diffusion des axes de lot
 template <typename T>
-NDarray<T> NDarray<T>::operator-(const NDarray<T> &other) const
+NDarray<T> NDarray<T>::matmul(const NDarray<T> &a, const NDarray<T> &b)
 {
-    if (shape != other.shape)
+    NDARRAY_TIMED("matmul");
+    if (a.shape.empty() || b.shape.empty())
+        throw std::invalid_argument("Le produit matriciel n'est pas défini pour les tableaux 0D");
+    if (a.shape.size() <= 2 && b.shape.size() <= 2)
+        return dot(a, b);
+
+    // Promotion des vecteurs : (k) devient (1, k) à gauche et (k, 1) à droite
+    std::vector<size_t> sa = a.shape, sb = b.shape;
+    std::vector<long long> ta = a.strides, tb = b.strides;
+    bool squeeze_m = false, squeeze_n = false;
+    if (sa.size() == 1)
     {
-        throw std::invalid_argument("Les formes doivent correspondre pour la soustraction");
+        sa.insert(sa.begin(), 1);
+        ta.insert(ta.begin(), 0);
+        squeeze_m = true;
     }
-    NDarray<T> result(shape);
-    for (size_t i = 0; i < data.size(); ++i)
+    if (sb.size() == 1)
     {
-        result.data[i] = data[i] - other.data[i];
+        sb.push_back(1);
+        tb.push_back(0);
+        squeeze_n = true;
     }
+    size_t m = sa[sa.size() - 2], k = sa.back(), n = sb.back();
+    if (sb[sb.size() - 2] != k)
+        throw std::invalid_argument("Les dimensions internes doivent correspondre pour le produit matriciel");
+
+    // Diffusion des axes de lot (alignés à droite)
+    size_t ba = sa.size() - 2, bb = sb.size() - 2, nb = std::max(ba, bb);
+    std::vector<size_t> batch(nb);
+    std::vector<long long> bsa(nb, 0), bsb(nb, 0);
+    for (size_t i = 0; i < nb; ++i)
+    {
+        size_t da = i + ba >= nb ? sa[i + ba - nb] : 1;
+        size_t db = i + bb >= nb ? sb[i + bb - nb] : 1;
+        if (da != db && da != 1 && db != 1)
+            throw std::invalid_argument("Les axes de lot ne sont pas compatibles pour le produit matriciel");
+        batch[i] = std::max(da, db);
+        if (i + ba >= nb && da != 1)
+            bsa[i] = ta[i + ba - nb];
+        if (i + bb >= nb && db != 1)
+            bsb[i] = tb[i + bb - nb];
+    }
+    size_t nbatch = 1;
+    for (size_t d : batch)
+        nbatch *= d;
+
+    std::vector<size_t> out_shape = batch;
+    if (!squeeze_m)
+        out_shape.push_back(m);
+    if (!squeeze_n)
+        out_shape.push_back(n);
+    NDarray<T> result(out_shape, 0);
+
+    long long rsa = ta[ta.size() - 2], csa = ta.back();
+    long long rsb = tb[tb.size() - 2], csb = tb.back();
+    const T *pa = a.data(), *pb = b.data();
+    T *pr = result.data();
+    // Beaucoup de petites matrices : on parallélise sur les lots plutôt qu'à l'intérieur de chaque produit
+    bool per_batch = nbatch >= nd::num_threads() && m * n * k < 64 * 64 * 64;
+    auto run = [&](size_t lo, size_t hi)
+    {
+        for (size_t t = lo; t < hi; ++t)
+        {
+            long long oa = 0, ob = 0;
+            size_t rem = t;
+            for (size_t i = nb; i > 0; --i)
+            {
+                size_t idx = rem % batch[i - 1];
+                rem /= batch[i - 1];
+                oa += static_cast<long long>(idx) * bsa[i - 1];
+                ob += static_cast<long long>(idx) * bsb[i - 1];
+            }
+            nd::detail::gemm<T>(m, n, k, pa + oa, rsa, csa, pb + ob, rsb, csb, pr + t * m * n, n, !per_batch);
+        }
+    };
+    if (per_batch)
+        nd::parallel_for(0, nbatch, 1, run);
+    else
+        run(0, nbatch);
     return result;
 }
 
-// Multiplie deux tableaux élément par élément
+// Prépare une réduction : normalise l'axe et calcule la forme du résultat
 template <typename T>
-NDarray<T> NDarray<T>::operator*(const NDarray<T> &other) const
+nd::detail::ReduceLayout NDarray<T>::reduce_layout(long long axis, bool all_axes, bool keepdims, std::vector<size_t> &out_shape) const
 {
-    if (shape != other.shape)
+    std::vector<bool> reduced(shape.size(), all_axes);
+    if (!all_axes)
     {
-        throw std::invalid_argument("Les formes doivent correspondre pour la multiplication");
+        if (axis < 0)
+            axis += static_cast<long long>(shape.size());
+        if (axis < 0 || axis >= static_cast<long long>(shape.size()))
+            throw std::out_of_range("Axe de réduction hors des limites");
+        reduced[static_cast<size_t>(axis)] = true;
     }
-    NDarray<T> result(shape);
-    for (size_t i = 0; i < data.size(); ++i)
+    out_shape.clear();
+    for (size_t d = 0; d < shape.size(); ++d)
     {
-        result.data[i] = data[i] * other.data[i];
+        if (!reduced[d])
+            out_shape.push_back(shape[d]);
+        else if (keepdims)
+            out_shape.push_back(1);
     }
+    return nd::detail::make_layout(shape, strides, reduced);
+}
+
+// Applique un réducteur le long d'un axe
+template <typename T>
+template <typename R, typename A>
+NDarray<A> NDarray<T>::reduce_to(long long axis, bool keepdims) const
+{
+    std::vector<size_t> out_shape;
+    nd::detail::ReduceLayout l = reduce_layout(axis, false, keepdims, out_shape);
+    NDarray<A> result(out_shape);
+    nd::detail::reduce<R>(data(), l, result.data());
     return result;
 }
 
-// Divise deux tableaux élément par élément
+// Variance : moyenne des carrés des écarts à la moyenne (deux passes, numériquement stable)
 template <typename T>
-NDarray<T> NDarray<T>::operator/(const NDarray<T> &other) const
+template <typename A>
+void NDarray<T>::variance(const nd::detail::ReduceLayout &l, A *out) const
 {
-    if (shape != other.shape)
-    {
-        throw std::invalid_argument("Les formes doivent correspondre pour la division");
-    }
-    NDarray<T> result(shape);
-    for (size_t i = 0; i < data.size(); ++i)
-    {
-        if (other.data[i] == 0)
-            throw std::runtime_error("Division par zéro détectée");
-        result.data[i] = data[i] / other.data[i];
-    }
+    std::vector<A> m(l.nout);
+    nd::detail::reduce<nd::detail::SumReducer<T, A>>(data(), l, m.data());
+    for (A &v : m)
+        v /= static_cast<A>(l.nred);
+    nd::detail::reduce<nd::detail::SqDevReducer<T, A>>(data(), l, out, m.data());
+    for (size_t o = 0; o < l.nout; ++o)
+        out[o] /= static_cast<A>(l.nred);
+}
+
+// Somme de tous les éléments
+template <typename T>
+T NDarray<T>::sum() const
+{
+    std::vector<size_t> out_shape;
+    T result;
+    nd::detail::reduce<nd::detail::SumReducer<T, T>>(data(), reduce_layout(0, true, false, out_shape), &result);
     return result;
 }
 
-// Ajoute un scalaire à chaque élément
 template <typename T>
-NDarray<T> NDarray<T>::operator+(T scalar) const
+NDarray<T> NDarray<T>::sum(long long axis, bool keepdims) const
 {
-    NDarray<T> result(shape);
-    for (size_t i = 0; i < data.size(); ++i)
-    {
-        result.data[i] = data[i] + scalar;
-    }
+    return reduce_to<nd::detail::SumReducer<T, T>, T>(axis, keepdims);
+}
+
+// Produit de tous les éléments
+template <typename T>
+T NDarray<T>::prod() const
+{
+    std::vector<size_t> out_shape;
+    T result;
+    nd::detail::reduce<nd::detail::ProdReducer<T, T>>(data(), reduce_layout(0, true, false, out_shape), &result);
     return result;
 }
 
-// Soustrait un scalaire à chaque élément
 template <typename T>
-NDarray<T> NDarray<T>::operator-(T scalar) const
+NDarray<T> NDarray<T>::prod(long long axis, bool keepdims) const
 {
-    NDarray<T> result(shape);
-    for (size_t i = 0; i < data.size(); ++i)
-    {
-        result.data[i] = data[i] - scalar;
-    }
+    return reduce_to<nd::detail::ProdReducer<T, T>, T>(axis, keepdims);
+}
+
+// Plus petit élément
+template <typename T>
+T NDarray<T>::min() const
+{
+    if (total_size == 0)
+        throw std::invalid_argument("Réduction impossible sur un tableau vide");
+    std::vector<size_t> out_shape;
+    T result;
+    nd::detail::reduce<nd::detail::MinReducer<T, T>>(data(), reduce_layout(0, true, false, out_shape), &result);
     return result;
 }
 
-// Multiplie chaque élément par un scalaire
 template <typename T>
-NDarray<T> NDarray<T>::operator*(T scalar) const
+NDarray<T> NDarray<T>::min(long long axis, bool keepdims) const
 {
-    NDarray<T> result(shape);
-    for (size_t i = 0; i < data.size(); ++i)
-    {
-        result.data[i] = data[i] * scalar;
-    }
+    if (total_size == 0)
+        throw std::invalid_argument("Réduction impossible sur un tableau vide");
+    return reduce_to<nd::detail::MinReducer<T, T>, T>(axis, keepdims);
+}
+
+// Plus grand élément
+template <typename T>
+T NDarray<T>::max() const
+{
+    if (total_size == 0)
+        throw std::invalid_argument("Réduction impossible sur un tableau vide");
+    std::vector<size_t> out_shape;
+    T result;
+    nd::detail::reduce<nd::detail::MaxReducer<T, T>>(data(), reduce_layout(0, true, false, out_shape), &result);
     return result;
 }
 
-// Divise chaque élément par un scalaire
 template <typename T>
-NDarray<T> NDarray<T>::operator/(T scalar) const
+NDarray<T> NDarray<T>::max(long long axis, bool keepdims) const
 {
-    if (scalar == 0)
-        throw std::runtime_error("Division par zéro détectée");
-    NDarray<T> result(shape);
-    for (size_t i = 0; i < data.size(); ++i)
-    {
-        result.data[i] = data[i] / scalar;
-    }
+    if (total_size == 0)
+        throw std::invalid_argument("Réduction impossible sur un tableau vide");
+    return reduce_to<nd::detail::MaxReducer<T, T>, T>(axis, keepdims);
+}
+
+// Index plat du plus petit élément
+template <typename T>
+size_t NDarray<T>::argmin() const
+{
+    std::vector<size_t> out_shape;
+    size_t result;
+    nd::detail::arg_reduce<false>(data(), reduce_layout(0, true, false, out_shape), &result);
     return result;
 }
 
-// Additionne deux tableaux (version fonctionnelle)
 template <typename T>
-NDarray<T> NDarray<T>::add(const NDarray<T> &a, const NDarray<T> &b)
+NDarray<size_t> NDarray<T>::argmin(long long axis, bool keepdims) const
 {
-    return a + b;
+    std::vector<size_t> out_shape;
+    nd::detail::ReduceLayout l = reduce_layout(axis, false, keepdims, out_shape);
+    NDarray<size_t> result(out_shape);
+    nd::detail::arg_reduce<false>(data(), l, result.data());
+    return result;
 }
 
-// Soustrait deux tableaux (version fonctionnelle)
+// Index plat du plus grand élément
 template <typename T>
-NDarray<T> NDarray<T>::subtract(const NDarray<T> &a, const NDarray<T> &b)
+size_t NDarray<T>::argmax() const
 {
-    return a - b;
+    std::vector<size_t> out_shape;
+    size_t result;
+    nd::detail::arg_reduce<true>(data(), reduce_layout(0, true, false, out_shape), &result);
+    return result;
 }
 
-// Multiplie deux tableaux (version fonctionnelle)
 template <typename T>
-NDarray<T> NDarray<T>::multiply(const NDarray<T> &a, const NDarray<T> &b)
+NDarray<size_t> NDarray<T>::argmax(long long axis, bool keepdims) const
 {
-    return a * b;
+    std::vector<size_t> out_shape;
+    nd::detail::ReduceLayout l = reduce_layout(axis, false, keepdims, out_shape);
+    NDarray<size_t> result(out_shape);
+    nd::detail::arg_reduce<true>(data(), l, result.data());
+    return result;
 }
 
-// Divise deux tableaux (version fonctionnelle)
+// Moyenne de tous les éléments
 template <typename T>
-NDarray<T> NDarray<T>::divide(const NDarray<T> &a, const NDarray<T> &b)
+nd::detail::real_t<T> NDarray<T>::mean() const
 {
-    return a / b;
+    using R = nd::detail::real_t<T>;
+    std::vector<size_t> out_shape;
+    R result;
+    nd::detail::reduce<nd::detail::SumReducer<T, R>>(data(), reduce_layout(0, true, false, out_shape), &result);
+    return result / static_cast<R>(total_size);
 }
 
-// Effectue un produit matriciel entre deux tableaux 2D
 template <typename T>
-NDarray<T> NDarray<T>::dot(const NDarray<T> &a, const NDarray<T> &b)
+NDarray<nd::detail::real_t<T>> NDarray<T>::mean(long long axis, bool keepdims) const
 {
-    if (a.shape.size() != 2 || b.shape.size() != 2)
-        throw std::invalid_argument("Le produit matriciel n'est supporté que pour les tableaux 2D");
-    if (a.shape[1] != b.shape[0])
-        throw std::invalid_argument("Les dimensions internes doivent correspondre pour le produit matriciel");
+    using R = nd::detail::real_t<T>;
+    std::vector<size_t> out_shape;
+    nd::detail::ReduceLayout l = reduce_layout(axis, false, keepdims, out_shape);
+    NDarray<R> result(out_shape);
+    R *out = result.data();
+    nd::detail::reduce<nd::detail::SumReducer<T, R>>(data(), l, out);
+    for (size_t o = 0; o < l.nout; ++o)
+        out[o] /= static_cast<R>(l.nred);
+    return result;
+}
 
-    NDarray<T> result({a.shape[0], b.shape[1]}, 0);
-    for (size_t i = 0; i < a.shape[0]; ++i)
-    {
-        for (size_t j = 0; j < b.shape[1]; ++j)
-        {
-            for (size_t k = 0; k < a.shape[1]; ++k)
-            {
-                result.data[i * result.strides[0] + j] +=
-                    a.data[i * a.strides[0] + k] * b.data[k * b.strides[0] + j]; // Calcule le produit
-            }
-        }
-    }
+// Variance de tous les éléments
+template <typename T>
+nd::detail::real_t<T> NDarray<T>::var() const
+{
+    std::vector<size_t> out_shape;
+    nd::detail::real_t<T> result;
+    variance(reduce_layout(0, true, false, out_shape), &result);
+    return result;
+}
+
+template <typename T>
+NDarray<nd::detail::real_t<T>> NDarray<T>::var(long long axis, bool keepdims) const
+{
+    std::vector<size_t> out_shape;
+    nd::detail::ReduceLayout l = reduce_layout(axis, false, keepdims, out_shape);
+    NDarray<nd::detail::real_t<T>> result(out_shape);
+    variance(l, result.data());
+    return result;
+}
+
+// Écart type (racine de la variance)
+template <typename T>
+nd::detail::real_t<T> NDarray<T>::stddev() const
+{
+    return std::sqrt(var());
+}
+
+template <typename T>
+NDarray<nd::detail::real_t<T>> NDarray<T>::stddev(long long axis, bool keepdims) const
+{
+    NDarray<nd::detail::real_t<T>> result = var(axis, keepdims);
+    nd::detail::real_t<T> *out = result.data();
+    for (size_t o = 0; o < result.getSize(); ++o)
+        out[o] = std::sqrt(out[o]);
     return result;
 }
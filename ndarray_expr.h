@@ -0,0 +1,773 @@
+#ifndef NDARRAY_EXPR_H
+#define NDARRAY_EXPR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ndarray_fwd.h"
+#include "ndarray_instrument.h"
+#include "ndarray_parallel.h"
+
+// Expressions paresseuses pour les opérateurs élément par élément
+// a * 2 + b - c ne crée aucun tableau intermédiaire : les opérateurs construisent un arbre
+// d'expression (connu à la compilation) qui est évalué en une seule boucle fusionnée
+// lors de l'affectation à un NDarray ou de l'appel à eval().
+namespace nd
+{
+    namespace detail
+    {
+        // Marqueur commun à tous les nœuds d'expression
+        struct ExprTag
+        {
+        };
+
+        template <typename E>
+        using is_expr = std::is_base_of<ExprTag, std::decay_t<E>>;
+
+        template <typename X>
+        struct is_ndarray : std::false_type
+        {
+        };
+        template <typename T, size_t N>
+        struct is_ndarray<NDarray<T, N>> : std::true_type
+        {
+        };
+
+        // Opérande « tableau » : NDarray (de rang dynamique ou statique) ou expression
+        template <typename X>
+        using is_array_operand = std::integral_constant<bool, is_ndarray<std::decay_t<X>>::value || is_expr<X>::value>;
+
+        template <typename X>
+        using is_scalar_operand = std::is_arithmetic<std::decay_t<X>>;
+
+        // Type des éléments d'un opérande tableau
+        template <typename X, typename = void>
+        struct value_of
+        {
+            using type = typename std::decay_t<X>::value_type;
+        };
+        template <typename T, size_t N>
+        struct value_of<NDarray<T, N>>
+        {
+            using type = T;
+        };
+
+        // Opérations élément par élément
+        struct AddOp
+        {
+            static constexpr const char *mismatch = "Les formes doivent correspondre pour l'addition";
+            template <typename T>
+            static T apply(T a, T b) { return static_cast<T>(a + b); }
+        };
+        struct SubOp
+        {
+            static constexpr const char *mismatch = "Les formes doivent correspondre pour la soustraction";
+            template <typename T>
+            static T apply(T a, T b) { return static_cast<T>(a - b); }
+        };
+        struct MulOp
+        {
+            static constexpr const char *mismatch = "Les formes doivent correspondre pour la multiplication";
+            template <typename T>
+            static T apply(T a, T b) { return static_cast<T>(a * b); }
+        };
+        struct DivOp
+        {
+            static constexpr const char *mismatch = "Les formes doivent correspondre pour la division";
+            template <typename T>
+            static T apply(T a, T b)
+            {
+                if (b == T(0))
+                    throw std::runtime_error("Division par zéro détectée");
+                return static_cast<T>(a / b);
+            }
+        };
+
+        // Longueur des blocs du parcours ligne par ligne
+        constexpr size_t eval_block = 1024;
+        // Nombre maximal de feuilles tableau pour lesquelles une boucle interne est générée par combinaison
+        // de feuilles diffusées le long de la ligne (2^n variantes) ; au-delà, seule la variante sans diffusion
+        constexpr unsigned max_row_variants_leaves = 4;
+        // Longueur de ligne en dessous de laquelle plusieurs lignes consécutives sont évaluées en une boucle
+        constexpr size_t tile_max_row = 32;
+
+        // Ensemble des pas (diffusés et alignés sur la forme du résultat) de chaque feuille tableau
+        using StrideSet = std::vector<std::vector<long long>>;
+
+        /**
+         * Forme résultant de la diffusion de deux formes (règles de NumPy) :
+         * les axes sont alignés à droite et chaque paire doit être égale ou contenir 1.
+         * @throws std::invalid_argument Avec le message what si les formes sont incompatibles.
+         */
+        inline std::vector<size_t> broadcast_shape(const std::vector<size_t> &a, const std::vector<size_t> &b, const char *what)
+        {
+            if (a == b)
+                return a;
+            size_t rank = std::max(a.size(), b.size());
+            std::vector<size_t> out(rank);
+            for (size_t d = 0; d < rank; ++d)
+            {
+                size_t da = d + a.size() >= rank ? a[d + a.size() - rank] : 1;
+                size_t db = d + b.size() >= rank ? b[d + b.size() - rank] : 1;
+                if (da != db && da != 1 && db != 1)
+                    throw std::invalid_argument(what);
+                out[d] = da == 1 ? db : da;
+            }
+            return out;
+        }
+
+        // Pas d'un tableau vu avec la forme out_shape : 0 sur les axes diffusés (aucune copie)
+        // (forme et pas en std::vector pour NDarray<T>, en std::array pour NDarray<T, N>)
+        template <typename Shape, typename Strides>
+        std::vector<long long> broadcast_strides(const Shape &shape, const Strides &strides, const std::vector<size_t> &out_shape)
+        {
+            size_t rank = out_shape.size(), lead = rank - shape.size();
+            std::vector<long long> out(rank, 0);
+            for (size_t d = lead; d < rank; ++d)
+                if (shape[d - lead] != 1)
+                    out[d] = strides[d - lead];
+            return out;
+        }
+
+        /**
+         * Simplifie le parcours : supprime les axes de taille 1 puis fusionne les axes voisins
+         * lorsque tous les opérandes les parcourent de façon contiguë l'un après l'autre.
+         * Un opérande de taille 1 ou diffusé en entier (pas nuls) ne bloque jamais la fusion.
+         */
+        inline void coalesce(std::vector<size_t> &shape, StrideSet &all)
+        {
+            std::vector<size_t> ns;
+            StrideSet na(all.size());
+            for (size_t d = 0; d < shape.size(); ++d)
+            {
+                if (shape[d] == 1)
+                    continue;
+                bool merge = !ns.empty();
+                for (size_t k = 0; merge && k < all.size(); ++k)
+                    merge = na[k].back() == all[k][d] * static_cast<long long>(shape[d]);
+                if (merge)
+                {
+                    ns.back() *= shape[d];
+                    for (size_t k = 0; k < all.size(); ++k)
+                        na[k].back() = all[k][d];
+                }
+                else
+                {
+                    ns.push_back(shape[d]);
+                    for (size_t k = 0; k < all.size(); ++k)
+                        na[k].push_back(all[k][d]);
+                }
+            }
+            if (ns.empty())
+            {
+                ns.push_back(1);
+                for (auto &s : na)
+                    s.push_back(0);
+            }
+            shape = std::move(ns);
+            all = std::move(na);
+        }
+
+        // Adresses du premier et du dernier élément d'un tableau non vide (pas éventuellement négatifs)
+        template <typename T, typename Shape, typename Strides>
+        std::pair<const T *, const T *> address_range(const T *p, const Shape &shape, const Strides &strides)
+        {
+            const T *lo = p, *hi = p;
+            for (size_t d = 0; d < shape.size(); ++d)
+            {
+                long long ext = static_cast<long long>(shape[d] - 1) * strides[d];
+                (ext < 0 ? lo : hi) += ext;
+            }
+            return {lo, hi};
+        }
+
+        // Feuille scalaire : la même valeur pour tous les éléments
+        template <typename T>
+        struct ScalarLeaf : ExprTag
+        {
+            using value_type = T;
+            static constexpr unsigned leaves = 0; // Feuilles tableau de l'expression
+            T value;
+
+            explicit ScalarLeaf(T v) : value(v) {}
+            bool is_scalar() const { return true; }
+            const std::vector<size_t> &shape() const
+            {
+                static const std::vector<size_t> none;
+                return none;
+            }
+            bool flat_ok(const std::vector<size_t> &) const { return true; }
+            T flat(size_t) const { return value; }
+            bool may_alias(const NDarray<T> &) const { return false; }
+            NDarray<T> *donor(const std::vector<size_t> &) { return nullptr; }
+            void strides_for(const std::vector<size_t> &, StrideSet &) const {}
+
+            struct Cursor
+            {
+                T value;
+                void seek(const size_t *, size_t) {}
+                void next_row() {}
+                void tile(size_t, size_t) {}
+                void skip_rows(size_t) {}
+                bool unit() const { return true; }
+                unsigned splat_mask(unsigned) const { return 0; }
+                T at(size_t) const { return value; }
+                template <unsigned Mask, unsigned Bit>
+                T at_row(size_t) const { return value; }
+            };
+            Cursor cursor(const StrideSet &, size_t &) const { return Cursor{value}; }
+        };
+
+        // Feuille tableau : référence vers un NDarray (Owned = false) ou tableau temporaire déplacé (Owned = true)
+        template <typename T, bool Owned>
+        struct ArrayLeaf : ExprTag
+        {
+            using value_type = T;
+            using Holder = std::conditional_t<Owned, NDarray<T>, const NDarray<T> &>;
+            static constexpr unsigned leaves = 1;
+            Holder arr;
+
+            explicit ArrayLeaf(const NDarray<T> &a) : arr(a) {}
+            explicit ArrayLeaf(NDarray<T> &&a) : arr(std::move(a)) {}
+            ArrayLeaf(const ArrayLeaf &) = default;
+            ArrayLeaf(ArrayLeaf &&) = default;
+
+            bool is_scalar() const { return false; }
+            const std::vector<size_t> &shape() const { return arr.getShape(); }
+            // Vrai si la feuille peut être lue avec l'index plat du résultat
+            bool flat_ok(const std::vector<size_t> &out_shape) const
+            {
+                return arr.is_contiguous() && arr.getShape() == out_shape;
+            }
+            T flat(size_t i) const { return arr.data()[i]; }
+            // Vrai si la feuille lit la mémoire de dst à d'autres positions que celles écrites
+            bool may_alias(const NDarray<T> &dst) const
+            {
+                return arr.shares_memory(dst) &&
+                       !(arr.data() == dst.data() && arr.getStrides() == dst.getStrides() && arr.getShape() == dst.getShape());
+            }
+            // Tableau temporaire dont le tampon peut être réutilisé pour le résultat
+            NDarray<T> *donor(const std::vector<size_t> &out_shape)
+            {
+                if constexpr (Owned)
+                {
+                    if (arr.is_contiguous() && arr.getShape() == out_shape)
+                        return &arr;
+                }
+                return nullptr;
+            }
+            void strides_for(const std::vector<size_t> &out_shape, StrideSet &all) const
+            {
+                all.push_back(broadcast_strides(arr.getShape(), arr.getStrides(), out_shape));
+            }
+
+            /**
+             * Curseur de parcours ligne par ligne (tableaux non contigus ou diffusés).
+             * Une feuille diffusée le long de la ligne (pas interne nul : colonne, tableau {1}) lit
+             * une seule valeur par ligne, gardée dans value ; les autres lisent row[j].
+             * En mode tuile (plusieurs lignes courtes lues comme une seule), une feuille dont les lignes
+             * ne se suivent pas en mémoire est recopiée dans tile_buf ; une ligne diffusée sur toutes
+             * les lignes (pas externe nul) n'y est recopiée qu'une fois.
+             */
+            struct Cursor
+            {
+                const T *base;
+                std::vector<long long> steps; // Pas des axes externes
+                long long inner;              // Pas du dernier axe
+                long long outer;              // Pas de l'avant-dernier axe (ligne suivante)
+                const T *src = nullptr;       // Début de la ligne courante dans le tableau
+                const T *row = nullptr;       // Lecture : src, ou tile_buf en mode tuile
+                T value{};                    // Premier élément de la ligne : valeur diffusée si inner == 0
+                std::vector<T> tile_buf;
+                const T *tile_src = nullptr; // Ligne recopiée dans tile_buf lorsque outer == 0
+                size_t tile_size = 0;
+
+                Cursor(const T *b, const std::vector<long long> &s)
+                    : base(b), steps(s.begin(), s.end() - 1), inner(s.back()), outer(steps.empty() ? 0 : steps.back()) {}
+                // Positionne le curseur sur la ligne idx, à partir de la colonne j0
+                void seek(const size_t *idx, size_t j0)
+                {
+                    const T *p = base;
+                    for (size_t d = 0; d < steps.size(); ++d)
+                        p += static_cast<long long>(idx[d]) * steps[d];
+                    row = src = p + static_cast<long long>(j0) * inner;
+                    value = *row;
+                }
+                // Passe au début de la ligne suivante de l'avant-dernier axe (après seek(idx, 0))
+                void next_row()
+                {
+                    row = src += outer;
+                    value = *row;
+                }
+                // Prépare la lecture à plat des rows lignes de len éléments qui commencent à src
+                void tile(size_t rows, size_t len)
+                {
+                    if (inner == 1 && outer == static_cast<long long>(len))
+                    {
+                        row = src;
+                        return;
+                    }
+                    if (!(outer == 0 && tile_src == src && tile_size >= rows * len))
+                    {
+                        tile_buf.resize(std::max(tile_buf.size(), rows * len));
+                        T *d = tile_buf.data();
+                        if (inner == 0)
+                            splat_rows(d, rows, len);
+                        else
+                            for (size_t r = 0; r < rows; ++r, d += len)
+                            {
+                                const T *p = src + static_cast<long long>(r) * outer;
+                                if (inner == 1)
+                                    std::copy(p, p + len, d);
+                                else
+                                    for (size_t j = 0; j < len; ++j)
+                                        d[j] = p[static_cast<long long>(j) * inner];
+                            }
+                        tile_src = src;
+                        tile_size = rows * len;
+                    }
+                    row = tile_buf.data();
+                }
+                void skip_rows(size_t rows) { src += static_cast<long long>(rows) * outer; }
+                // Répète la valeur de chaque ligne (colonne diffusée) sur len éléments ; longueur fixe si possible
+                void splat_rows(T *d, size_t rows, size_t len) const
+                {
+                    switch (len)
+                    {
+                    case 2:
+                        return splat_rows<2>(d, rows);
+                    case 4:
+                        return splat_rows<4>(d, rows);
+                    case 8:
+                        return splat_rows<8>(d, rows);
+                    case 16:
+                        return splat_rows<16>(d, rows);
+                    default:
+                        for (size_t r = 0; r < rows; ++r, d += len)
+                            std::fill(d, d + len, src[static_cast<long long>(r) * outer]);
+                    }
+                }
+                template <size_t Len>
+                void splat_rows(T *d, size_t rows) const
+                {
+                    for (size_t r = 0; r < rows; ++r, d += Len)
+                    {
+                        T v = src[static_cast<long long>(r) * outer];
+                        for (size_t j = 0; j < Len; ++j)
+                            d[j] = v;
+                    }
+                }
+                bool unit() const { return inner == 1 || inner == 0; }
+                // Bit de la feuille si elle est diffusée le long de la ligne (au-delà de 32 feuilles, le bit 31 sert pour toutes)
+                unsigned splat_mask(unsigned bit) const { return inner == 0 ? 1u << std::min(bit, 31u) : 0u; }
+                T at(size_t j) const { return row[static_cast<long long>(j) * inner]; }
+                // Lecture à pas unitaire ; le bit Bit de Mask indique à la compilation une valeur diffusée
+                template <unsigned Mask, unsigned Bit>
+                T at_row(size_t j) const
+                {
+                    if constexpr (((Mask >> Bit) & 1u) != 0)
+                        return value;
+                    else
+                        return row[j];
+                }
+            };
+            Cursor cursor(const StrideSet &all, size_t &k) const { return Cursor(arr.data(), all[k++]); }
+        };
+
+        /**
+         * Feuille tableau de rang statique : référence vers un NDarray<T, N> (Owned = false) ou temporaire
+         * déplacé (Owned = true). Les éléments sont lus en place, y compris ceux d'un petit tableau stocké
+         * dans l'objet ; le parcours ligne par ligne est celui d'ArrayLeaf.
+         */
+        template <typename T, size_t N, bool Owned>
+        struct StaticLeaf : ExprTag
+        {
+            using value_type = T;
+            using Holder = std::conditional_t<Owned, NDarray<T, N>, const NDarray<T, N> &>;
+            using Cursor = typename ArrayLeaf<T, false>::Cursor;
+            static constexpr unsigned leaves = 1;
+            Holder arr;
+            std::vector<size_t> dims; // Forme sous la forme attendue par les nœuds d'expression
+
+            explicit StaticLeaf(const NDarray<T, N> &a) : arr(a), dims(a.getShape().begin(), a.getShape().end()) {}
+            explicit StaticLeaf(NDarray<T, N> &&a) : arr(std::move(a)), dims(arr.getShape().begin(), arr.getShape().end()) {}
+
+            bool is_scalar() const { return false; }
+            const std::vector<size_t> &shape() const { return dims; }
+            bool flat_ok(const std::vector<size_t> &out_shape) const { return arr.is_contiguous() && dims == out_shape; }
+            T flat(size_t i) const { return arr.data()[i]; }
+            // Chevauchement des plages d'adresses, sauf lecture exacte des positions écrites
+            bool may_alias(const NDarray<T> &dst) const
+            {
+                if (arr.getSize() == 0 || dst.getSize() == 0)
+                    return false;
+                auto a = address_range(arr.data(), arr.getShape(), arr.getStrides());
+                auto d = address_range(static_cast<const T *>(dst.data()), dst.getShape(), dst.getStrides());
+                std::less<const T *> before;
+                if (before(a.second, d.first) || before(d.second, a.first))
+                    return false;
+                return !(arr.data() == dst.data() && dims == dst.getShape() &&
+                         std::equal(arr.getStrides().begin(), arr.getStrides().end(), dst.getStrides().begin()));
+            }
+            NDarray<T> *donor(const std::vector<size_t> &) { return nullptr; }
+            void strides_for(const std::vector<size_t> &out_shape, StrideSet &all) const
+            {
+                all.push_back(broadcast_strides(arr.getShape(), arr.getStrides(), out_shape));
+            }
+            Cursor cursor(const StrideSet &all, size_t &k) const { return Cursor(arr.data(), all[k++]); }
+        };
+
+        // Nœud binaire : applique Op aux éléments de deux sous-expressions
+        template <typename Op, typename L, typename R>
+        struct BinaryExpr : ExprTag
+        {
+            using value_type = typename L::value_type;
+            static constexpr unsigned leaves = L::leaves + R::leaves;
+            L lhs;
+            R rhs;
+            std::vector<size_t> out_shape;
+
+            BinaryExpr(L l, R r) : lhs(std::move(l)), rhs(std::move(r))
+            {
+                if (lhs.is_scalar())
+                    out_shape = rhs.shape();
+                else if (rhs.is_scalar())
+                    out_shape = lhs.shape();
+                else
+                    out_shape = broadcast_shape(lhs.shape(), rhs.shape(), Op::mismatch);
+            }
+
+            bool is_scalar() const { return lhs.is_scalar() && rhs.is_scalar(); }
+            const std::vector<size_t> &shape() const { return out_shape; }
+            bool flat_ok(const std::vector<size_t> &s) const { return lhs.flat_ok(s) && rhs.flat_ok(s); }
+            value_type flat(size_t i) const { return Op::apply(lhs.flat(i), rhs.flat(i)); }
+            bool may_alias(const NDarray<value_type> &dst) const { return lhs.may_alias(dst) || rhs.may_alias(dst); }
+            NDarray<value_type> *donor(const std::vector<size_t> &s)
+            {
+                NDarray<value_type> *d = lhs.donor(s);
+                return d ? d : rhs.donor(s);
+            }
+            void strides_for(const std::vector<size_t> &s, StrideSet &all) const
+            {
+                lhs.strides_for(s, all);
+                rhs.strides_for(s, all);
+            }
+
+            struct Cursor
+            {
+                typename L::Cursor l;
+                typename R::Cursor r;
+                void seek(const size_t *idx, size_t j0)
+                {
+                    l.seek(idx, j0);
+                    r.seek(idx, j0);
+                }
+                void next_row()
+                {
+                    l.next_row();
+                    r.next_row();
+                }
+                void tile(size_t rows, size_t len)
+                {
+                    l.tile(rows, len);
+                    r.tile(rows, len);
+                }
+                void skip_rows(size_t rows)
+                {
+                    l.skip_rows(rows);
+                    r.skip_rows(rows);
+                }
+                bool unit() const { return l.unit() && r.unit(); }
+                unsigned splat_mask(unsigned bit) const { return l.splat_mask(bit) | r.splat_mask(bit + L::leaves); }
+                value_type at(size_t j) const { return Op::apply(l.at(j), r.at(j)); }
+                template <unsigned Mask, unsigned Bit>
+                value_type at_row(size_t j) const
+                {
+                    return Op::apply(l.template at_row<Mask, Bit>(j), r.template at_row<Mask, Bit + L::leaves>(j));
+                }
+            };
+            // L'ordre d'évaluation des initialiseurs entre accolades garantit le parcours gauche-droite de all
+            Cursor cursor(const StrideSet &all, size_t &k) const { return Cursor{lhs.cursor(all, k), rhs.cursor(all, k)}; }
+
+            // Évalue l'expression dans un nouveau tableau
+            NDarray<value_type> eval() const & { return NDarray<value_type>(*this); }
+            NDarray<value_type> eval() && { return NDarray<value_type>(std::move(*this)); }
+        };
+
+        // Convertit un opérande en nœud d'expression
+        template <typename T>
+        ArrayLeaf<T, false> wrap(const NDarray<T> &a) { return ArrayLeaf<T, false>(a); }
+        template <typename T>
+        ArrayLeaf<T, true> wrap(NDarray<T> &&a) { return ArrayLeaf<T, true>(std::move(a)); }
+        template <typename T, size_t N, typename = std::enable_if_t<N != dynamic_rank>>
+        StaticLeaf<T, N, false> wrap(const NDarray<T, N> &a) { return StaticLeaf<T, N, false>(a); }
+        template <typename T, size_t N, typename = std::enable_if_t<N != dynamic_rank>>
+        StaticLeaf<T, N, true> wrap(NDarray<T, N> &&a) { return StaticLeaf<T, N, true>(std::move(a)); }
+        template <typename T, typename E, typename = std::enable_if_t<is_expr<E>::value>>
+        std::decay_t<E> wrap(E &&e) { return std::forward<E>(e); }
+        template <typename T, typename S, typename = std::enable_if_t<is_scalar_operand<S>::value>, typename = void>
+        ScalarLeaf<T> wrap(S s) { return ScalarLeaf<T>(static_cast<T>(s)); }
+
+        template <typename T, typename X>
+        using wrapped_t = decltype(wrap<T>(std::declval<X>()));
+
+        // Type des éléments d'une paire d'opérandes (au moins l'un des deux est un tableau)
+        template <typename A, typename B>
+        using common_value_t = typename value_of<std::decay_t<std::conditional_t<is_array_operand<A>::value, A, B>>>::type;
+
+        // Paire d'opérandes acceptée par les opérateurs arithmétiques
+        template <typename A, typename B>
+        using enable_binary_t = std::enable_if_t<
+            (is_array_operand<A>::value && (is_array_operand<B>::value || is_scalar_operand<B>::value)) ||
+            (is_scalar_operand<A>::value && is_array_operand<B>::value)>;
+
+        // Opérande accepté par les opérateurs composés (+=, -=, ...)
+        template <typename B>
+        using enable_compound_t = std::enable_if_t<is_array_operand<B>::value || is_scalar_operand<B>::value>;
+
+        template <typename Op, typename A, typename B>
+        auto make_binary(A &&a, B &&b)
+        {
+            using T = common_value_t<A, B>;
+            if constexpr (is_array_operand<A>::value && is_array_operand<B>::value)
+                static_assert(std::is_same<T, typename value_of<std::decay_t<B>>::type>::value,
+                              "Les deux opérandes doivent avoir le même type d'éléments");
+            return BinaryExpr<Op, wrapped_t<T, A>, wrapped_t<T, B>>(wrap<T>(std::forward<A>(a)), wrap<T>(std::forward<B>(b)));
+        }
+
+        // Parcours ligne par ligne de dst : forme simplifiée par coalesce et pas de la destination
+        template <typename T>
+        struct RowLayout
+        {
+            const std::vector<size_t> &shape;
+            const std::vector<long long> &ds;
+            T *dst;
+            size_t inner; // Longueur d'une ligne
+            size_t nblk;  // Blocs de eval_block éléments par ligne
+        };
+
+        // Écrit len éléments de la ligne courante du curseur dans out (pas os)
+        template <bool Unit, unsigned Mask, typename C, typename T>
+        inline void eval_row(const C &cur, T *out, long long os, size_t len)
+        {
+            // Aucune dépendance entre itérations : une feuille qui chevauche dst ailleurs qu'à la position
+            // écrite est d'abord recopiée (voir may_alias), on évite ainsi les tests de recouvrement par ligne
+            if constexpr (Unit)
+            {
+#pragma GCC ivdep
+                for (size_t j = 0; j < len; ++j)
+                    out[j] = cur.template at_row<Mask, 0>(j);
+            }
+            else
+            {
+#pragma GCC ivdep
+                for (size_t j = 0; j < len; ++j)
+                    out[static_cast<long long>(j) * os] = cur.at(j);
+            }
+        }
+
+        /**
+         * Évalue les unités [lo, hi) (blocs de ligne) du parcours ligne par ligne.
+         * Unit : dst et les feuilles sont à pas unitaire ou diffusées le long de la ligne (bits de Mask),
+         * la boucle interne est alors vectorisable ; sinon lecture générale avec les pas.
+         * Les lignes courtes (un bloc) se suivent par simple décalage des pointeurs de l'avant-dernier axe ;
+         * le curseur n'est repositionné que lorsque cet axe revient à zéro.
+         */
+        template <bool Unit, unsigned Mask, typename C, typename T>
+        void eval_rows(C &cur, const RowLayout<T> &lay, size_t lo, size_t hi)
+        {
+            const std::vector<size_t> &shape = lay.shape;
+            const std::vector<long long> &ds = lay.ds;
+            size_t rank = shape.size(), inner = lay.inner, nblk = lay.nblk;
+            long long os = ds[rank - 1], orow = ds[rank - 2];
+            std::vector<size_t> idx(rank - 1, 0);
+            size_t r = lo / nblk, b = lo % nblk;
+            for (size_t d = rank - 1; d > 0; --d)
+            {
+                idx[d - 1] = r % shape[d - 1];
+                r /= shape[d - 1];
+            }
+            for (size_t u = lo; u < hi;)
+            {
+                T *row = lay.dst;
+                for (size_t d = 0; d + 1 < rank; ++d)
+                    row += static_cast<long long>(idx[d]) * ds[d];
+                size_t count; // Lignes traitées avant le prochain repositionnement
+                if (nblk == 1)
+                {
+                    count = std::min(shape[rank - 2] - idx[rank - 2], hi - u);
+                    cur.seek(idx.data(), 0);
+                    if (Unit && inner <= tile_max_row && orow == static_cast<long long>(inner) && count > 1)
+                    {
+                        // Lignes très courtes et consécutives dans dst : tuiles d'environ eval_block éléments lues à plat
+                        size_t tile_rows = eval_block / inner;
+                        for (size_t q = 0; q < count;)
+                        {
+                            size_t rows = std::min(tile_rows, count - q);
+                            cur.tile(rows, inner);
+                            eval_row<true, 0>(cur, row, 1, rows * inner);
+                            cur.skip_rows(rows);
+                            row += static_cast<long long>(rows * inner);
+                            q += rows;
+                        }
+                    }
+                    else
+                        for (size_t q = 0;;)
+                        {
+                            eval_row<Unit, Mask>(cur, row, os, inner);
+                            if (++q == count)
+                                break;
+                            row += orow;
+                            cur.next_row();
+                        }
+                    u += count;
+                }
+                else
+                {
+                    // Lignes longues : un repositionnement par bloc de eval_block éléments
+                    count = 1;
+                    for (; b < nblk && u < hi; ++b, ++u)
+                    {
+                        size_t j0 = b * eval_block;
+                        cur.seek(idx.data(), j0);
+                        eval_row<Unit, Mask>(cur, row + static_cast<long long>(j0) * os, os, std::min(eval_block, inner - j0));
+                    }
+                    b = 0;
+                }
+                // Avance de count lignes avec retenue sur les axes externes
+                idx[rank - 2] += count;
+                for (size_t d = rank - 1; d > 0 && idx[d - 1] >= shape[d - 1]; --d)
+                {
+                    idx[d - 1] = 0;
+                    if (d > 1)
+                        ++idx[d - 2];
+                }
+            }
+        }
+
+        // Choisit à l'exécution la variante de eval_rows correspondant aux feuilles diffusées (mask)
+        template <unsigned Leaves, unsigned M = 0, typename C, typename T>
+        void eval_rows_unit(unsigned mask, C &cur, const RowLayout<T> &lay, size_t lo, size_t hi)
+        {
+            if constexpr (M + 1 < (1u << Leaves))
+            {
+                if (mask != M)
+                    return eval_rows_unit<Leaves, M + 1>(mask, cur, lay, lo, hi);
+            }
+            eval_rows<true, M>(cur, lay, lo, hi);
+        }
+
+        /**
+         * Évalue expr dans dst (de la forme du résultat) en une seule boucle.
+         * Chemin rapide : dst et toutes les feuilles contiguës de même forme, boucle plate vectorisable.
+         * Sinon (vues, diffusion) : les axes sont simplifiés par coalesce puis parcourus ligne par ligne,
+         * par blocs de eval_block éléments, avec les pas de chaque feuille (nuls sur les axes diffusés).
+         * Une ligne diffusée (ligne {D} sur {N, D}) est relue à chaque ligne par le même pointeur et une
+         * colonne ({N, 1}) ou un tableau {1} donne une valeur par ligne : la boucle interne reste vectorisée.
+         * Les grands tableaux sont répartis entre les threads du pool (plages d'index ou de blocs de ligne,
+         * plusieurs lignes courtes par unité de travail).
+         */
+        template <typename T, typename E>
+        void evaluate(const E &expr, NDarray<T> &dst)
+        {
+            NDARRAY_TIMED("evaluate");
+            size_t n = dst.getSize();
+            if (n == 0)
+                return;
+            if (dst.is_contiguous() && expr.flat_ok(dst.getShape()))
+            {
+                T *out = dst.data();
+                parallel_for_elements(n, 1, [&](size_t lo, size_t hi)
+                                      {
+                    for (size_t i = lo; i < hi; ++i)
+                        out[i] = expr.flat(i); });
+                return;
+            }
+            std::vector<size_t> shape = dst.getShape();
+            StrideSet all;
+            all.push_back(dst.getStrides()); // all[0] : destination
+            expr.strides_for(shape, all);
+            coalesce(shape, all);
+            if (shape.size() == 1)
+            {
+                // Une seule ligne : un axe externe de taille 1 permet le même parcours
+                shape.insert(shape.begin(), 1);
+                for (auto &s : all)
+                    s.insert(s.begin(), 0);
+            }
+
+            size_t rank = shape.size();
+            size_t inner = shape[rank - 1];
+            RowLayout<T> lay{shape, all[0], dst.data(), inner, (inner + eval_block - 1) / eval_block};
+            bool unit_dst = all[0][rank - 1] == 1;
+            // Une unité de travail est un bloc d'une ligne : les lignes longues se répartissent aussi
+            parallel_for_elements(n / inner * lay.nblk, std::min(inner, eval_block), [&](size_t lo, size_t hi)
+                                  {
+                size_t k = 1;
+                auto cur = expr.cursor(all, k);
+                if (!unit_dst || !cur.unit())
+                    return eval_rows<false, 0>(cur, lay, lo, hi);
+                unsigned mask = cur.splat_mask(0);
+                if constexpr (E::leaves <= max_row_variants_leaves)
+                    eval_rows_unit<E::leaves>(mask, cur, lay, lo, hi);
+                else if (mask == 0)
+                    eval_rows<true, 0>(cur, lay, lo, hi);
+                else
+                    eval_rows<false, 0>(cur, lay, lo, hi); });
+        }
+
+        // Opérateur composé (+=, -=, ...) : écrit directement dans dst
+        template <typename Op, typename T, typename B>
+        void compound(NDarray<T> &dst, B &&rhs)
+        {
+            auto expr = make_binary<Op>(static_cast<const NDarray<T> &>(dst), std::forward<B>(rhs));
+            if (expr.shape() != dst.getShape())
+                throw std::invalid_argument(Op::mismatch);
+            if (expr.may_alias(dst))
+            {
+                // Les opérandes chevauchent dst à d'autres positions : on passe par un tableau temporaire
+                NDarray<T> tmp(expr);
+                evaluate(wrap<T>(static_cast<const NDarray<T> &>(tmp)), dst);
+                return;
+            }
+            evaluate(expr, dst);
+        }
+    }
+
+    // Opérateurs arithmétiques élément par élément (tableaux, expressions et scalaires)
+    template <typename A, typename B, typename = detail::enable_binary_t<A, B>>
+    auto operator+(A &&a, B &&b) { return detail::make_binary<detail::AddOp>(std::forward<A>(a), std::forward<B>(b)); }
+
+    template <typename A, typename B, typename = detail::enable_binary_t<A, B>>
+    auto operator-(A &&a, B &&b) { return detail::make_binary<detail::SubOp>(std::forward<A>(a), std::forward<B>(b)); }
+
+    template <typename A, typename B, typename = detail::enable_binary_t<A, B>>
+    auto operator*(A &&a, B &&b) { return detail::make_binary<detail::MulOp>(std::forward<A>(a), std::forward<B>(b)); }
+
+    template <typename A, typename B, typename = detail::enable_binary_t<A, B>>
+    auto operator/(A &&a, B &&b)
+    {
+        if constexpr (detail::is_scalar_operand<B>::value)
+        {
+            if (b == 0)
+                throw std::runtime_error("Division par zéro détectée");
+        }
+        return detail::make_binary<detail::DivOp>(std::forward<A>(a), std::forward<B>(b));
+    }
+
+    // Évalue une expression (ou copie un tableau) dans un nouveau NDarray
+    template <typename E, typename = std::enable_if_t<detail::is_expr<E>::value>>
+    auto eval(E &&expr) { return std::forward<E>(expr).eval(); }
+}
+
+// Les opérateurs sont visibles depuis l'espace de noms global, où NDarray est déclaré
+using nd::operator+;
+using nd::operator-;
+using nd::operator*;
+using nd::operator/;
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef NDARRAY_FWD_H
+#define NDARRAY_FWD_H
+
+#include <cstddef>
+
+namespace nd
+{
+    // Rang « dynamique » : le nombre de dimensions n'est connu qu'à l'exécution
+    constexpr size_t dynamic_rank = static_cast<size_t>(-1);
+}
+
+// Déclaration anticipée : NDarray<T> a un rang dynamique, NDarray<T, N> un rang N fixé à la compilation
+template <typename T, size_t N = nd::dynamic_rank>
+class NDarray;
+
+#endif
@@ -0,0 +1,442 @@
+#ifndef NDARRAY_GEMM_H
+#define NDARRAY_GEMM_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "ndarray_instrument.h"
+#include "ndarray_parallel.h"
+
+// Moteur de produit matriciel utilisé par NDarray::dot et NDarray::matmul
+// Organisation « à la BLIS » : les blocs de A et B sont recopiés (packing) dans des panneaux
+// contigus dimensionnés pour les caches, puis un micro-noyau calcule une tuile MR x NR de C
+// en registres. Le jeu d'instructions (AVX-512, AVX2 ou générique) est choisi à l'exécution ; sans extensions
+// vectorielles (ou avec NDARRAY_NO_SIMD), un micro-noyau scalaire garde le même blocage et les threads.
+
+#if defined(__GNUC__)
+#define NDARRAY_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define NDARRAY_ALWAYS_INLINE inline
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(NDARRAY_NO_SIMD)
+#define NDARRAY_X86_DISPATCH 1
+#endif
+
+namespace nd
+{
+    namespace detail
+    {
+        // Types pris en charge par les micro-noyaux vectoriels (extensions vectorielles de GCC/Clang)
+        template <typename T>
+        struct gemm_simd_ok
+            : std::integral_constant<bool,
+#if defined(__GNUC__) && !defined(NDARRAY_NO_SIMD)
+                                     std::is_same<T, float>::value || std::is_same<T, double>::value ||
+                                         (std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                          (sizeof(T) == 4 || sizeof(T) == 8))
+#else
+                                     false
+#endif
+                                     >
+        {
+        };
+
+        // Jeux d'instructions disponibles pour les micro-noyaux
+        enum class Isa
+        {
+            generic,
+            avx2,
+            avx512
+        };
+
+        // Détecte une seule fois le meilleur jeu d'instructions du processeur
+        inline Isa detect_isa()
+        {
+#ifdef NDARRAY_X86_DISPATCH
+            static const Isa isa = []()
+            {
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512f"))
+                    return Isa::avx512;
+                if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+                    return Isa::avx2;
+                return Isa::generic;
+            }();
+            return isa;
+#else
+            return Isa::generic;
+#endif
+        }
+
+        // Signature commune des micro-noyaux : C[mr x nr] += Ap[MR x kc] * Bp[kc x NR]
+        template <typename T>
+        using MicroKernel = void (*)(size_t kc, const T *a, const T *b, T *c, size_t ldc, size_t mr, size_t nr);
+
+#if defined(__GNUC__) && !defined(NDARRAY_NO_SIMD)
+        /**
+         * Micro-noyau générique : VB est la largeur d'un registre vectoriel en octets.
+         * Les MR x (NR / lanes) accumulateurs restent en registres pendant toute la boucle sur k.
+         * La fonction est toujours « inlinée » dans un wrapper compilé pour le jeu d'instructions visé.
+         */
+        template <typename T, int VB, int MR, int NR>
+        NDARRAY_ALWAYS_INLINE void micro_kernel(size_t kc, const T *a, const T *b, T *c, size_t ldc, size_t mr, size_t nr)
+        {
+            typedef T V __attribute__((vector_size(VB)));
+            constexpr int L = VB / static_cast<int>(sizeof(T)); // Nombre d'éléments par registre
+            constexpr int NV = NR / L;                          // Registres par ligne de tuile
+            V acc[MR][NV];
+#pragma GCC unroll 16
+            for (int i = 0; i < MR; ++i)
+#pragma GCC unroll 16
+                for (int v = 0; v < NV; ++v)
+                    acc[i][v] = V{};
+            for (size_t p = 0; p < kc; ++p)
+            {
+                V bv[NV];
+#pragma GCC unroll 16
+                for (int v = 0; v < NV; ++v)
+                    std::memcpy(&bv[v], b + v * L, VB);
+#pragma GCC unroll 16
+                for (int i = 0; i < MR; ++i)
+                {
+                    T ai = a[i];
+#pragma GCC unroll 16
+                    for (int v = 0; v < NV; ++v)
+                        acc[i][v] += ai * bv[v]; // Contracté en FMA lorsque disponible
+                }
+                a += MR;
+                b += NR;
+            }
+            if (mr == static_cast<size_t>(MR) && nr == static_cast<size_t>(NR))
+            {
+#pragma GCC unroll 16
+                for (int i = 0; i < MR; ++i)
+#pragma GCC unroll 16
+                    for (int v = 0; v < NV; ++v)
+                    {
+                        V cv;
+                        std::memcpy(&cv, c + i * ldc + v * L, VB);
+                        cv += acc[i][v];
+                        std::memcpy(c + i * ldc + v * L, &cv, VB);
+                    }
+                return;
+            }
+            // Tuile de bord : on passe par un tampon pour n'écrire que les mr x nr éléments valides
+            T tmp[MR][NR];
+            std::memcpy(tmp, acc, sizeof(tmp));
+            for (size_t i = 0; i < mr; ++i)
+                for (size_t j = 0; j < nr; ++j)
+                    c[i * ldc + j] += tmp[i][j];
+        }
+
+        // Paramètres de tuile pour un type et une largeur de registre donnés
+        template <typename T, int VB, int MRows>
+        struct KernelConfig
+        {
+            static constexpr int MR = MRows;
+            static constexpr int NR = 2 * VB / static_cast<int>(sizeof(T));
+        };
+
+        template <typename T>
+        using GenericConfig = KernelConfig<T, 16, 4>;
+
+        template <typename T>
+        void kernel_generic(size_t kc, const T *a, const T *b, T *c, size_t ldc, size_t mr, size_t nr)
+        {
+            micro_kernel<T, 16, GenericConfig<T>::MR, GenericConfig<T>::NR>(kc, a, b, c, ldc, mr, nr);
+        }
+
+#ifdef NDARRAY_X86_DISPATCH
+        template <typename T>
+        using Avx2Config = KernelConfig<T, 32, 6>;
+        template <typename T>
+        using Avx512Config = KernelConfig<T, 64, 8>;
+
+        template <typename T>
+        __attribute__((target("avx2,fma"))) void kernel_avx2(size_t kc, const T *a, const T *b, T *c, size_t ldc, size_t mr, size_t nr)
+        {
+            micro_kernel<T, 32, Avx2Config<T>::MR, Avx2Config<T>::NR>(kc, a, b, c, ldc, mr, nr);
+        }
+
+        template <typename T>
+        __attribute__((target("avx512f"))) void kernel_avx512(size_t kc, const T *a, const T *b, T *c, size_t ldc, size_t mr, size_t nr)
+        {
+            micro_kernel<T, 64, Avx512Config<T>::MR, Avx512Config<T>::NR>(kc, a, b, c, ldc, mr, nr);
+        }
+#endif
+#endif
+
+        /**
+         * Micro-noyau scalaire portable, pour les compilateurs sans extensions vectorielles, la
+         * compilation avec NDARRAY_NO_SIMD et les types non vectorisables : les accumulateurs
+         * MR x NR restent locaux, le compilateur les place en registres (ou les vectorise) lui-même.
+         */
+        template <typename T, int MR, int NR>
+        void kernel_scalar(size_t kc, const T *a, const T *b, T *c, size_t ldc, size_t mr, size_t nr)
+        {
+            T acc[MR][NR];
+            for (int i = 0; i < MR; ++i)
+                for (int j = 0; j < NR; ++j)
+                    acc[i][j] = T(0);
+            for (size_t p = 0; p < kc; ++p)
+            {
+                for (int i = 0; i < MR; ++i)
+                {
+                    T ai = a[i];
+                    for (int j = 0; j < NR; ++j)
+                        acc[i][j] += ai * b[j];
+                }
+                a += MR;
+                b += NR;
+            }
+            for (size_t i = 0; i < mr; ++i)
+                for (size_t j = 0; j < nr; ++j)
+                    c[i * ldc + j] += acc[i][j];
+        }
+
+        struct ScalarConfig
+        {
+            static constexpr int MR = 4;
+            static constexpr int NR = 4;
+        };
+
+        // Recopie un bloc mc x kc de A en panneaux de MR lignes (complétés par des zéros)
+        template <typename T>
+        void pack_a(size_t mc, size_t kc, const T *a, long long rsa, long long csa, T *dst, size_t MR)
+        {
+            for (size_t ir = 0; ir < mc; ir += MR)
+            {
+                size_t mr = std::min(MR, mc - ir);
+                for (size_t p = 0; p < kc; ++p)
+                {
+                    const T *src = a + static_cast<long long>(ir) * rsa + static_cast<long long>(p) * csa;
+                    for (size_t i = 0; i < mr; ++i)
+                        dst[i] = src[static_cast<long long>(i) * rsa];
+                    for (size_t i = mr; i < MR; ++i)
+                        dst[i] = T(0);
+                    dst += MR;
+                }
+            }
+        }
+
+        // Recopie un bloc kc x nc de B en panneaux de NR colonnes (complétés par des zéros)
+        template <typename T>
+        void pack_b(size_t kc, size_t nc, const T *b, long long rsb, long long csb, T *dst, size_t NR)
+        {
+            for (size_t jr = 0; jr < nc; jr += NR)
+            {
+                size_t nr = std::min(NR, nc - jr);
+                for (size_t p = 0; p < kc; ++p)
+                {
+                    const T *src = b + static_cast<long long>(p) * rsb + static_cast<long long>(jr) * csb;
+                    if (csb == 1)
+                        std::copy(src, src + nr, dst);
+                    else
+                        for (size_t j = 0; j < nr; ++j)
+                            dst[j] = src[static_cast<long long>(j) * csb];
+                    for (size_t j = nr; j < NR; ++j)
+                        dst[j] = T(0);
+                    dst += NR;
+                }
+            }
+        }
+
+        /**
+         * Boucles de blocage autour d'un micro-noyau MR x NR.
+         * Pour chaque panneau kc x nc de B (recopié une seule fois, en parallèle, puis partagé), les
+         * tuiles mc x ns de C sont réparties entre les threads ; chacune recopie son bloc de A.
+         */
+        template <typename T, int MR, int NR>
+        void gemm_blocked(MicroKernel<T> kernel, size_t m, size_t n, size_t k,
+                          const T *a, long long rsa, long long csa,
+                          const T *b, long long rsb, long long csb,
+                          T *c, size_t ldc, bool parallel)
+        {
+            // kc : un micro-panneau de B tient dans L1 ; mc : un bloc de A tient dans L2 ; nc : le panneau de B dans L3
+            const size_t KC = std::max<size_t>(64, std::min<size_t>(512, 16384 / (NR * sizeof(T))));
+            const size_t MC = std::max<size_t>(MR, (262144 / (KC * sizeof(T))) / MR * MR);
+            const size_t NC = std::max<size_t>(NR, (2097152 / (KC * sizeof(T))) / NR * NR);
+            size_t kc_max = std::min(KC, k);
+            size_t nc = std::min(NC, (n + NR - 1) / NR * NR);
+            std::vector<T> bp(nc * kc_max);
+
+            // Réduit les tuiles tant qu'il n'y en a pas assez pour occuper tous les threads
+            size_t mc = MC, ns = nc;
+            size_t threads = parallel ? num_threads() : 1;
+            auto tiles = [&]()
+            { return ((m + mc - 1) / mc) * ((nc + ns - 1) / ns); };
+            while (tiles() < 2 * threads && (mc > 4 * static_cast<size_t>(MR) || ns > 4 * static_cast<size_t>(NR)))
+            {
+                if (mc >= ns / 4 && mc > 4 * static_cast<size_t>(MR))
+                    mc = (mc / 2 + MR - 1) / MR * MR;
+                else
+                    ns = (ns / 2 + NR - 1) / NR * NR;
+            }
+            size_t mt = (m + mc - 1) / mc;
+
+            for (size_t jc = 0; jc < n; jc += nc)
+            {
+                size_t ncur = std::min(nc, n - jc);
+                size_t npanels = (ncur + NR - 1) / NR, nt = (ncur + ns - 1) / ns;
+                for (size_t pc = 0; pc < k; pc += KC)
+                {
+                    size_t kc = std::min(KC, k - pc);
+                    const T *bsrc = b + static_cast<long long>(pc) * rsb + static_cast<long long>(jc) * csb;
+                    auto pack = [&](size_t lo, size_t hi)
+                    {
+                        size_t j0 = lo * NR, j1 = std::min(ncur, hi * NR);
+                        pack_b(kc, j1 - j0, bsrc + static_cast<long long>(j0) * csb, rsb, csb, bp.data() + j0 * kc, NR);
+                    };
+                    auto work = [&](size_t lo, size_t hi)
+                    {
+                        std::vector<T> ap(((mc + MR - 1) / MR) * MR * kc);
+                        for (size_t t = lo; t < hi; ++t)
+                        {
+                            size_t ic = (t / nt) * mc, js = (t % nt) * ns;
+                            size_t mcur = std::min(mc, m - ic), nscur = std::min(ns, ncur - js);
+                            pack_a(mcur, kc, a + static_cast<long long>(ic) * rsa + static_cast<long long>(pc) * csa, rsa, csa, ap.data(), MR);
+                            for (size_t jr = js; jr < js + nscur; jr += NR)
+                                for (size_t ir = 0; ir < mcur; ir += MR)
+                                    kernel(kc, ap.data() + ir * kc, bp.data() + jr * kc,
+                                           c + (ic + ir) * ldc + jc + jr, ldc,
+                                           std::min<size_t>(MR, mcur - ir), std::min<size_t>(NR, js + nscur - jr));
+                        }
+                    };
+                    if (parallel)
+                    {
+                        parallel_for(0, npanels, std::max<size_t>(1, 16384 / (kc * NR)), pack);
+                        parallel_for(0, mt * nt, 1, work);
+                    }
+                    else
+                    {
+                        pack(0, npanels);
+                        work(0, mt * nt);
+                    }
+                }
+            }
+        }
+
+        // Produit naïf (ordre i-k-j) pour les petites matrices et les booléens
+        template <typename T>
+        void gemm_simple(size_t m, size_t n, size_t k,
+                         const T *a, long long rsa, long long csa,
+                         const T *b, long long rsb, long long csb,
+                         T *c, size_t ldc)
+        {
+            for (size_t i = 0; i < m; ++i)
+            {
+                T *ci = c + i * ldc;
+                for (size_t p = 0; p < k; ++p)
+                {
+                    T aip = a[static_cast<long long>(i) * rsa + static_cast<long long>(p) * csa];
+                    const T *bp = b + static_cast<long long>(p) * rsb;
+                    for (size_t j = 0; j < n; ++j)
+                        ci[j] += aip * bp[static_cast<long long>(j) * csb];
+                }
+            }
+        }
+
+        /**
+         * C (m x n, lignes contiguës de pas ldc) += A (m x k) * B (k x n).
+         * A et B sont décrits par leurs pas de ligne et de colonne, ce qui permet de
+         * multiplier directement des vues (transposées, tranches) sans les copier.
+         */
+        template <typename T>
+        void gemm(size_t m, size_t n, size_t k,
+                  const T *a, long long rsa, long long csa,
+                  const T *b, long long rsb, long long csb,
+                  T *c, size_t ldc, bool parallel = true)
+        {
+            NDARRAY_TIMED("gemm");
+            if (m == 0 || n == 0 || k == 0)
+                return;
+            if (m * n * k > 4096) // En dessous, le packing coûte plus qu'il ne rapporte
+            {
+#if defined(__GNUC__) && !defined(NDARRAY_NO_SIMD)
+                if constexpr (gemm_simd_ok<T>::value)
+                {
+#ifdef NDARRAY_X86_DISPATCH
+                    switch (detect_isa())
+                    {
+                    case Isa::avx512:
+                        gemm_blocked<T, Avx512Config<T>::MR, Avx512Config<T>::NR>(&kernel_avx512<T>, m, n, k, a, rsa, csa, b, rsb, csb, c, ldc, parallel);
+                        return;
+                    case Isa::avx2:
+                        gemm_blocked<T, Avx2Config<T>::MR, Avx2Config<T>::NR>(&kernel_avx2<T>, m, n, k, a, rsa, csa, b, rsb, csb, c, ldc, parallel);
+                        return;
+                    default:
+                        break;
+                    }
+#endif
+                    gemm_blocked<T, GenericConfig<T>::MR, GenericConfig<T>::NR>(&kernel_generic<T>, m, n, k, a, rsa, csa, b, rsb, csb, c, ldc, parallel);
+                    return;
+                }
+#endif
+                // Les panneaux sont des std::vector<T> : vector<bool> n'a pas de data(), les booléens restent naïfs
+                if constexpr (!gemm_simd_ok<T>::value && !std::is_same<T, bool>::value)
+                {
+                    gemm_blocked<T, ScalarConfig::MR, ScalarConfig::NR>(&kernel_scalar<T, ScalarConfig::MR, ScalarConfig::NR>,
+                                                                        m, n, k, a, rsa, csa, b, rsb, csb, c, ldc, parallel);
+                    return;
+                }
+            }
+            gemm_simple(m, n, k, a, rsa, csa, b, rsb, csb, c, ldc);
+        }
+
+        /**
+         * Produit matrice-vecteur : y (m, contigu) += A (m x k) * x (k, pas incx).
+         * Lignes contiguës : produit scalaire par ligne ; sinon formulation « axpy » par colonne.
+         */
+        template <typename T>
+        void gemv(size_t m, size_t k, const T *a, long long rsa, long long csa,
+                  const T *x, long long incx, T *y, bool parallel = true)
+        {
+            NDARRAY_TIMED("gemv");
+            if (m == 0 || k == 0)
+                return;
+            auto rows = [&](size_t lo, size_t hi)
+            {
+                if (csa == 1 && incx == 1)
+                {
+                    for (size_t i = lo; i < hi; ++i)
+                    {
+                        const T *ai = a + static_cast<long long>(i) * rsa;
+                        // Quatre accumulateurs indépendants pour casser la chaîne de dépendances
+                        T s0 = T(0), s1 = T(0), s2 = T(0), s3 = T(0);
+                        size_t p = 0;
+                        for (; p + 4 <= k; p += 4)
+                        {
+                            s0 += ai[p] * x[p];
+                            s1 += ai[p + 1] * x[p + 1];
+                            s2 += ai[p + 2] * x[p + 2];
+                            s3 += ai[p + 3] * x[p + 3];
+                        }
+                        for (; p < k; ++p)
+                            s0 += ai[p] * x[p];
+                        y[i] += (s0 + s1) + (s2 + s3);
+                    }
+                }
+                else
+                {
+                    for (size_t p = 0; p < k; ++p)
+                    {
+                        T xp = x[static_cast<long long>(p) * incx];
+                        const T *ap = a + static_cast<long long>(p) * csa;
+                        for (size_t i = lo; i < hi; ++i)
+                            y[i] += ap[static_cast<long long>(i) * rsa] * xp;
+                    }
+                }
+            };
+            if (parallel)
+                parallel_for(0, m, std::max<size_t>(1, 32768 / k), rows);
+            else
+                rows(0, m);
+        }
+    }
+}
+
+#endif
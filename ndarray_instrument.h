@@ -0,0 +1,144 @@
+#ifndef NDARRAY_INSTRUMENT_H
+#define NDARRAY_INSTRUMENT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ndarray_memory.h"
+
+// Instrumentation optionnelle (compiler avec -DNDARRAY_INSTRUMENT) : nombre d'appels et temps
+// de chaque opération, octets copiés. Sans la macro, les points de mesure ne coûtent rien.
+namespace nd
+{
+    namespace detail
+    {
+        // Compteurs d'une opération ; le temps est inclusif (une opération qui en appelle une autre compte les deux)
+        struct OpCounter
+        {
+            const char *name = nullptr;
+            std::atomic<uint64_t> calls{0};
+            std::atomic<uint64_t> ns{0};
+        };
+
+        struct OpRegistry
+        {
+            std::mutex mutex;
+            std::deque<OpCounter> ops; // deque : les références restent valides quand on ajoute une opération
+
+            static OpRegistry &instance()
+            {
+                static OpRegistry *r = new OpRegistry(); // Jamais détruit : utilisable jusqu'à la fin du programme
+                return *r;
+            }
+            OpCounter &get(const char *name)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (OpCounter &c : ops)
+                    if (std::strcmp(c.name, name) == 0)
+                        return c;
+                ops.emplace_back();
+                ops.back().name = name;
+                return ops.back();
+            }
+        };
+
+        inline std::atomic<uint64_t> bytes_copied{0};
+        inline std::atomic<uint64_t> baseline_allocations{0};
+        inline std::atomic<uint64_t> baseline_bytes{0};
+
+        class ScopedOpTimer
+        {
+        public:
+            explicit ScopedOpTimer(OpCounter &c) : counter(c), start(std::chrono::steady_clock::now()) {}
+            ~ScopedOpTimer()
+            {
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                counter.calls.fetch_add(1, std::memory_order_relaxed);
+                counter.ns.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+            }
+            ScopedOpTimer(const ScopedOpTimer &) = delete;
+            ScopedOpTimer &operator=(const ScopedOpTimer &) = delete;
+
+        private:
+            OpCounter &counter;
+            std::chrono::steady_clock::time_point start;
+        };
+    }
+
+    namespace instrument
+    {
+#ifdef NDARRAY_INSTRUMENT
+        constexpr bool enabled = true;
+#else
+        constexpr bool enabled = false;
+#endif
+
+        struct OpReport
+        {
+            std::string name;
+            uint64_t calls;
+            double total_ms;
+        };
+
+        // Compteurs depuis le dernier reset()
+        struct Report
+        {
+            uint64_t allocations = 0;     // Tampons alloués
+            uint64_t bytes_allocated = 0; // Octets alloués
+            size_t peak_bytes = 0;        // Pic d'utilisation mémoire
+            uint64_t bytes_copied = 0;    // Octets recopiés d'un tampon à un autre
+            std::vector<OpReport> ops;    // Opérations appelées au moins une fois
+        };
+
+        inline Report report()
+        {
+            MemoryStats m = memory_stats();
+            Report r;
+            r.allocations = m.allocations - detail::baseline_allocations;
+            r.bytes_allocated = m.bytes_allocated - detail::baseline_bytes;
+            r.peak_bytes = m.peak_bytes;
+            r.bytes_copied = detail::bytes_copied;
+            detail::OpRegistry &reg = detail::OpRegistry::instance();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            for (const detail::OpCounter &c : reg.ops)
+                if (c.calls > 0)
+                    r.ops.push_back(OpReport{c.name, c.calls, static_cast<double>(c.ns) / 1e6});
+            return r;
+        }
+
+        inline void reset()
+        {
+            MemoryStats m = memory_stats();
+            detail::baseline_allocations = m.allocations;
+            detail::baseline_bytes = m.bytes_allocated;
+            reset_peak_memory();
+            detail::bytes_copied = 0;
+            detail::OpRegistry &reg = detail::OpRegistry::instance();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            for (detail::OpCounter &c : reg.ops)
+            {
+                c.calls = 0;
+                c.ns = 0;
+            }
+        }
+    }
+}
+
+#ifdef NDARRAY_INSTRUMENT
+// Mesure le temps de la portée courante sous le nom name (au plus une mesure par portée)
+#define NDARRAY_TIMED(name)                                                                               \
+    static nd::detail::OpCounter &ndarray_op_counter_ = nd::detail::OpRegistry::instance().get(name); \
+    nd::detail::ScopedOpTimer ndarray_op_timer_(ndarray_op_counter_)
+// Compte bytes octets copiés
+#define NDARRAY_COUNT_COPY(bytes) nd::detail::bytes_copied.fetch_add(static_cast<uint64_t>(bytes), std::memory_order_relaxed)
+#else
+#define NDARRAY_TIMED(name) ((void)0)
+#define NDARRAY_COUNT_COPY(bytes) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,657 @@
+#ifndef NDARRAY_IO_H
+#define NDARRAY_IO_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "ndarray_fwd.h"
+#include "ndarray_parallel.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define NDARRAY_HAS_MMAP 1
+#endif
+
+// Lecture et écriture des formats NumPy .npy et .npz
+namespace nd
+{
+    /**
+     * Mode de chargement d'un tableau :
+     *  - copy       : les données sont lues dans un tampon alloué ;
+     *  - map        : le tampon est une projection privée du fichier, les pages sont lues à la demande
+     *                 et les modifications restent locales au processus ;
+     *  - map_shared : projection partagée, les modifications sont écrites dans le fichier.
+     */
+    enum class LoadMode
+    {
+        copy,
+        map,
+        map_shared
+    };
+
+    namespace detail
+    {
+        inline bool host_little_endian()
+        {
+            const uint16_t probe = 1;
+            unsigned char first;
+            std::memcpy(&first, &probe, 1);
+            return first == 1;
+        }
+
+        // Descripteur de type NumPy de T (ex. "<f8")
+        template <typename T>
+        std::string npy_descr()
+        {
+            static_assert(std::is_arithmetic<T>::value, "Le format .npy ne supporte que les types arithmétiques");
+            char kind = std::is_same<T, bool>::value          ? 'b'
+                        : std::is_floating_point<T>::value    ? 'f'
+                        : std::is_signed<T>::value            ? 'i'
+                                                              : 'u';
+            char order = sizeof(T) == 1 ? '|' : (host_little_endian() ? '<' : '>');
+            return std::string(1, order) + kind + std::to_string(sizeof(T));
+        }
+
+        // Vérifie que descr (lu dans un fichier) décrit T ; renvoie vrai si les octets doivent être inversés
+        template <typename T>
+        bool check_npy_descr(const std::string &descr)
+        {
+            std::string expected = npy_descr<T>();
+            if (descr.size() < 2 || descr.substr(1) != expected.substr(1))
+                throw std::invalid_argument("Type du fichier (" + descr + ") incompatible avec le type du tableau (" + expected + ")");
+            char order = descr[0];
+            if (sizeof(T) == 1 || order == '|' || order == '=')
+                return false;
+            if (order != '<' && order != '>')
+                throw std::runtime_error("Ordre des octets inconnu dans l'en-tête .npy : " + descr);
+            return (order == '<') != host_little_endian();
+        }
+
+        inline void byteswap(void *data, size_t count, size_t width)
+        {
+            unsigned char *p = static_cast<unsigned char *>(data);
+            parallel_for_elements(count, 1, [&](size_t lo, size_t hi)
+                                  {
+                for (size_t i = lo; i < hi; ++i)
+                    std::reverse(p + i * width, p + (i + 1) * width); });
+        }
+
+        // Contenu de l'en-tête d'un fichier .npy
+        struct NpyHeader
+        {
+            std::string descr;
+            bool fortran_order = false;
+            std::vector<size_t> shape;
+            uint64_t data_pos = 0; // Position des données dans le fichier
+        };
+
+        // Analyse le dictionnaire Python de l'en-tête, ex. {'descr': '<f8', 'fortran_order': False, 'shape': (3, 4), }
+        inline NpyHeader parse_npy_dict(const std::string &h)
+        {
+            size_t i = 0;
+            auto fail = [&h]()
+            { throw std::runtime_error("En-tête .npy invalide : " + h); };
+            auto skip = [&]()
+            { while (i < h.size() && (h[i] == ' ' || h[i] == '\n' || h[i] == '\t')) ++i; };
+            auto expect = [&](char c)
+            { skip(); if (i >= h.size() || h[i] != c) fail(); ++i; };
+            auto string_literal = [&]()
+            {
+                skip();
+                if (i >= h.size() || (h[i] != '\'' && h[i] != '"'))
+                    fail();
+                char q = h[i++];
+                size_t end = h.find(q, i);
+                if (end == std::string::npos)
+                    fail();
+                std::string s = h.substr(i, end - i);
+                i = end + 1;
+                return s;
+            };
+
+            NpyHeader header;
+            bool seen_descr = false, seen_order = false, seen_shape = false;
+            expect('{');
+            for (;;)
+            {
+                skip();
+                if (i < h.size() && h[i] == '}')
+                    break;
+                std::string key = string_literal();
+                expect(':');
+                skip();
+                if (key == "descr")
+                {
+                    header.descr = string_literal();
+                    seen_descr = true;
+                }
+                else if (key == "fortran_order")
+                {
+                    if (h.compare(i, 4, "True") == 0)
+                        header.fortran_order = true, i += 4;
+                    else if (h.compare(i, 5, "False") == 0)
+                        i += 5;
+                    else
+                        fail();
+                    seen_order = true;
+                }
+                else if (key == "shape")
+                {
+                    expect('(');
+                    for (;;)
+                    {
+                        skip();
+                        if (i < h.size() && h[i] == ')')
+                            break;
+                        size_t start = i;
+                        while (i < h.size() && h[i] >= '0' && h[i] <= '9')
+                            ++i;
+                        if (i == start)
+                            fail();
+                        header.shape.push_back(static_cast<size_t>(std::stoull(h.substr(start, i - start))));
+                        skip();
+                        if (i < h.size() && h[i] == ',')
+                            ++i;
+                    }
+                    ++i;
+                    seen_shape = true;
+                }
+                else
+                    fail();
+                skip();
+                if (i < h.size() && h[i] == ',')
+                    ++i;
+            }
+            if (!seen_descr || !seen_order || !seen_shape)
+                fail();
+            return header;
+        }
+
+        // Lit l'en-tête d'un flux .npy positionné sur son nombre magique
+        inline NpyHeader read_npy_header(std::istream &in)
+        {
+            char magic[8];
+            if (!in.read(magic, 8) || std::memcmp(magic, "\x93NUMPY", 6) != 0)
+                throw std::runtime_error("Le fichier n'est pas au format .npy");
+            unsigned char major = static_cast<unsigned char>(magic[6]);
+            if (major < 1 || major > 3)
+                throw std::runtime_error("Version du format .npy non supportée : " + std::to_string(major));
+            unsigned char len[4] = {0, 0, 0, 0};
+            size_t len_bytes = major == 1 ? 2 : 4;
+            if (!in.read(reinterpret_cast<char *>(len), static_cast<std::streamsize>(len_bytes)))
+                throw std::runtime_error("En-tête .npy tronqué");
+            uint32_t hlen = len[0] | (len[1] << 8) | (len[2] << 16) | (static_cast<uint32_t>(len[3]) << 24);
+            std::string dict(hlen, '\0');
+            if (!in.read(&dict[0], hlen))
+                throw std::runtime_error("En-tête .npy tronqué");
+            NpyHeader header = parse_npy_dict(dict);
+            header.data_pos = static_cast<uint64_t>(in.tellg());
+            return header;
+        }
+
+        // Construit l'en-tête complet (nombre magique compris), complété pour aligner les données sur 64 octets
+        inline std::string make_npy_header(const std::string &descr, const std::vector<size_t> &shape)
+        {
+            std::string dict = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': (";
+            for (size_t k = 0; k < shape.size(); ++k)
+                dict += (k ? ", " : "") + std::to_string(shape[k]);
+            if (shape.size() == 1)
+                dict += ','; // Tuple Python à un élément : (3,)
+            dict += "), }";
+            // Version 1.0 (longueur sur 2 octets) tant que l'en-tête complété tient, 2.0 sinon
+            size_t prefix = (10 + dict.size() + 1 + 63) / 64 * 64 - 10 < 65536 ? 10 : 12;
+            size_t total = (prefix + dict.size() + 1 + 63) / 64 * 64;
+            dict.append(total - prefix - dict.size() - 1, ' ');
+            dict += '\n';
+            std::string header("\x93NUMPY", 6);
+            header += static_cast<char>(prefix == 10 ? 1 : 2);
+            header += '\0';
+            size_t hlen = dict.size();
+            for (size_t b = 0; b < prefix - 8; ++b)
+                header += static_cast<char>((hlen >> (8 * b)) & 0xff);
+            return header + dict;
+        }
+
+        // Projette une plage du fichier en mémoire ; le tampon démappe la projection à sa destruction
+        template <typename T>
+        std::shared_ptr<T[]> map_file(const std::string &path, uint64_t pos, uint64_t nbytes, bool shared)
+        {
+#ifdef NDARRAY_HAS_MMAP
+            int fd = ::open(path.c_str(), shared ? O_RDWR : O_RDONLY);
+            if (fd < 0)
+                throw std::runtime_error("Impossible d'ouvrir le fichier " + path);
+            uint64_t page = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+            uint64_t base = pos / page * page;
+            size_t len = static_cast<size_t>(nbytes + (pos - base));
+            void *addr = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, shared ? MAP_SHARED : MAP_PRIVATE, fd, static_cast<off_t>(base));
+            ::close(fd);
+            if (addr == MAP_FAILED)
+                throw std::runtime_error("Échec de la projection mémoire de " + path);
+            std::shared_ptr<void> mapping(addr, [len](void *p)
+                                          { ::munmap(p, len); });
+            return std::shared_ptr<T[]>(mapping, reinterpret_cast<T *>(static_cast<char *>(addr) + (pos - base)));
+#else
+            (void)pos, (void)nbytes, (void)shared;
+            throw std::runtime_error("Projection mémoire non disponible sur cette plateforme : " + path);
+#endif
+        }
+
+        // CRC-32 (polynôme de zlib) par tranches de 8 octets
+        inline uint32_t crc32(uint32_t crc, const void *data, size_t n)
+        {
+            static const auto table = []()
+            {
+                std::vector<uint32_t> t(8 * 256);
+                for (uint32_t i = 0; i < 256; ++i)
+                {
+                    uint32_t c = i;
+                    for (int k = 0; k < 8; ++k)
+                        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    t[i] = c;
+                }
+                for (size_t s = 1; s < 8; ++s)
+                    for (size_t i = 0; i < 256; ++i)
+                        t[s * 256 + i] = (t[(s - 1) * 256 + i] >> 8) ^ t[t[(s - 1) * 256 + i] & 0xff];
+                return t;
+            }();
+            const unsigned char *p = static_cast<const unsigned char *>(data);
+            const uint32_t *t = table.data();
+            crc = ~crc;
+            for (; n >= 8; n -= 8, p += 8)
+            {
+                uint32_t lo = crc ^ (p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24));
+                uint32_t hi = p[4] | (p[5] << 8) | (p[6] << 16) | (static_cast<uint32_t>(p[7]) << 24);
+                crc = t[7 * 256 + (lo & 0xff)] ^ t[6 * 256 + ((lo >> 8) & 0xff)] ^
+                      t[5 * 256 + ((lo >> 16) & 0xff)] ^ t[4 * 256 + (lo >> 24)] ^
+                      t[3 * 256 + (hi & 0xff)] ^ t[2 * 256 + ((hi >> 8) & 0xff)] ^
+                      t[1 * 256 + ((hi >> 16) & 0xff)] ^ t[hi >> 24];
+            }
+            for (; n > 0; --n, ++p)
+                crc = t[(crc ^ *p) & 0xff] ^ (crc >> 8);
+            return ~crc;
+        }
+
+        // Entiers petit-boutistes des structures ZIP
+        inline uint64_t get_le(const unsigned char *p, size_t bytes)
+        {
+            uint64_t v = 0;
+            for (size_t b = bytes; b > 0; --b)
+                v = (v << 8) | p[b - 1];
+            return v;
+        }
+        inline void put_le(std::string &out, uint64_t v, size_t bytes)
+        {
+            for (size_t b = 0; b < bytes; ++b)
+                out += static_cast<char>((v >> (8 * b)) & 0xff);
+        }
+
+        // Membre d'une archive .npz
+        struct ZipEntry
+        {
+            std::string name;      // Nom sans le suffixe .npy
+            uint16_t method = 0;   // 0 : stocké sans compression
+            uint64_t size = 0;     // Taille non compressée
+            uint64_t header = 0;   // Position de l'en-tête local
+        };
+
+        // Lit le répertoire central d'une archive ZIP (ZIP64 compris)
+        inline std::vector<ZipEntry> read_zip_directory(const std::string &path)
+        {
+            std::ifstream in(path, std::ios::binary);
+            if (!in)
+                throw std::runtime_error("Impossible d'ouvrir le fichier " + path);
+            in.seekg(0, std::ios::end);
+            uint64_t fsize = static_cast<uint64_t>(in.tellg());
+            // L'enregistrement de fin (22 octets) est suivi d'un commentaire d'au plus 65535 octets
+            uint64_t tail = std::min<uint64_t>(fsize, 22 + 65535);
+            std::vector<unsigned char> buf(tail);
+            in.seekg(static_cast<std::streamoff>(fsize - tail));
+            in.read(reinterpret_cast<char *>(buf.data()), static_cast<std::streamsize>(tail));
+            size_t eocd = tail;
+            for (size_t i = tail >= 22 ? tail - 22 + 1 : 0; i-- > 0;)
+                if (get_le(&buf[i], 4) == 0x06054b50)
+                {
+                    eocd = i;
+                    break;
+                }
+            if (eocd == tail)
+                throw std::runtime_error("Archive .npz invalide : " + path);
+            uint64_t count = get_le(&buf[eocd + 10], 2);
+            uint64_t cd_size = get_le(&buf[eocd + 12], 4);
+            uint64_t cd_pos = get_le(&buf[eocd + 16], 4);
+            uint64_t eocd_pos = fsize - tail + eocd;
+            if ((count == 0xffff || cd_size == 0xffffffff || cd_pos == 0xffffffff) && eocd_pos >= 20)
+            {
+                // Localisateur ZIP64 juste avant l'enregistrement de fin
+                unsigned char loc[20], rec[56];
+                in.seekg(static_cast<std::streamoff>(eocd_pos - 20));
+                in.read(reinterpret_cast<char *>(loc), 20);
+                if (in && get_le(loc, 4) == 0x07064b50)
+                {
+                    in.seekg(static_cast<std::streamoff>(get_le(loc + 8, 8)));
+                    if (!in.read(reinterpret_cast<char *>(rec), 56) || get_le(rec, 4) != 0x06064b50)
+                        throw std::runtime_error("Archive .npz invalide : " + path);
+                    count = get_le(rec + 32, 8);
+                    cd_size = get_le(rec + 40, 8);
+                    cd_pos = get_le(rec + 48, 8);
+                }
+            }
+            std::vector<unsigned char> cd(static_cast<size_t>(cd_size));
+            in.clear();
+            in.seekg(static_cast<std::streamoff>(cd_pos));
+            if (!in.read(reinterpret_cast<char *>(cd.data()), static_cast<std::streamsize>(cd_size)))
+                throw std::runtime_error("Archive .npz tronquée : " + path);
+
+            std::vector<ZipEntry> entries;
+            size_t p = 0;
+            for (uint64_t e = 0; e < count; ++e)
+            {
+                if (p + 46 > cd.size() || get_le(&cd[p], 4) != 0x02014b50)
+                    throw std::runtime_error("Répertoire central invalide dans " + path);
+                ZipEntry entry;
+                entry.method = static_cast<uint16_t>(get_le(&cd[p + 10], 2));
+                uint64_t csize = get_le(&cd[p + 20], 4);
+                entry.size = get_le(&cd[p + 24], 4);
+                size_t nlen = get_le(&cd[p + 28], 2), xlen = get_le(&cd[p + 30], 2), clen = get_le(&cd[p + 32], 2);
+                entry.header = get_le(&cd[p + 42], 4);
+                if (p + 46 + nlen + xlen > cd.size())
+                    throw std::runtime_error("Répertoire central invalide dans " + path);
+                entry.name.assign(reinterpret_cast<const char *>(&cd[p + 46]), nlen);
+                // Champ supplémentaire ZIP64 : seules les valeurs saturées y figurent, dans cet ordre
+                for (size_t x = p + 46 + nlen, xend = x + xlen; x + 4 <= xend;)
+                {
+                    size_t id = get_le(&cd[x], 2), len = get_le(&cd[x + 2], 2);
+                    if (id == 0x0001)
+                    {
+                        size_t f = x + 4;
+                        if (entry.size == 0xffffffff && f + 8 <= x + 4 + len)
+                            entry.size = get_le(&cd[f], 8), f += 8;
+                        if (csize == 0xffffffff && f + 8 <= x + 4 + len)
+                            csize = get_le(&cd[f], 8), f += 8;
+                        if (entry.header == 0xffffffff && f + 8 <= x + 4 + len)
+                            entry.header = get_le(&cd[f], 8);
+                    }
+                    x += 4 + len;
+                }
+                if (entry.name.size() > 4 && entry.name.compare(entry.name.size() - 4, 4, ".npy") == 0)
+                    entry.name.erase(entry.name.size() - 4);
+                entries.push_back(std::move(entry));
+                p += 46 + nlen + xlen + clen;
+            }
+            return entries;
+        }
+
+        // Position du flux .npy du membre name d'une archive .npz
+        inline uint64_t npz_member_pos(const std::string &path, const std::string &name)
+        {
+            for (const ZipEntry &e : read_zip_directory(path))
+            {
+                if (e.name != name)
+                    continue;
+                if (e.method != 0)
+                    throw std::runtime_error("Membre compressé non supporté (utiliser numpy.savez plutôt que savez_compressed) : " + name);
+                std::ifstream in(path, std::ios::binary);
+                unsigned char local[30];
+                in.seekg(static_cast<std::streamoff>(e.header));
+                if (!in.read(reinterpret_cast<char *>(local), 30) || get_le(local, 4) != 0x04034b50)
+                    throw std::runtime_error("En-tête local invalide dans " + path);
+                return e.header + 30 + get_le(local + 26, 2) + get_le(local + 28, 2);
+            }
+            throw std::out_of_range("Tableau introuvable dans l'archive : " + name);
+        }
+    }
+
+    // Noms des tableaux d'une archive .npz
+    inline std::vector<std::string> npz_names(const std::string &path)
+    {
+        std::vector<std::string> names;
+        for (const detail::ZipEntry &e : detail::read_zip_directory(path))
+            names.push_back(e.name);
+        return names;
+    }
+
+    /**
+     * Écrit un fichier .npy par morceaux, pour produire des tableaux plus grands que la mémoire :
+     *     nd::NpyWriter<float> w("grand.npy", {lignes, colonnes});
+     *     for (...) w.write(bloc); // éléments successifs dans l'ordre C
+     *     w.close();               // vérifie que tous les éléments ont été écrits
+     */
+    template <typename T>
+    class NpyWriter
+    {
+    public:
+        NpyWriter(const std::string &path, const std::vector<size_t> &shape)
+            : out(path, std::ios::binary | std::ios::trunc), total(1)
+        {
+            if (!out)
+                throw std::runtime_error("Impossible de créer le fichier " + path);
+            for (size_t d : shape)
+                total *= d;
+            std::string header = detail::make_npy_header(detail::npy_descr<T>(), shape);
+            out.write(header.data(), static_cast<std::streamsize>(header.size()));
+        }
+        ~NpyWriter()
+        {
+            if (out.is_open())
+                out.close(); // Fichier incomplet si close() n'a pas été appelé
+        }
+        NpyWriter(const NpyWriter &) = delete;
+        NpyWriter &operator=(const NpyWriter &) = delete;
+
+        // Ajoute count éléments à la suite de ceux déjà écrits
+        void write(const T *values, size_t count)
+        {
+            if (count > total - done)
+                throw std::invalid_argument("Le flux dépasse la taille annoncée du tableau");
+            out.write(reinterpret_cast<const char *>(values), static_cast<std::streamsize>(count * sizeof(T)));
+            if (!out)
+                throw std::runtime_error("Erreur d'écriture du fichier .npy");
+            done += count;
+        }
+        // Ajoute les éléments de chunk (dans l'ordre C)
+        void write(const NDarray<T> &chunk)
+        {
+            NDarray<T> c = chunk.contiguous();
+            write(c.data(), c.getSize());
+        }
+        size_t written() const { return done; }
+
+        void close()
+        {
+            if (done != total)
+                throw std::runtime_error("Fichier .npy incomplet : " + std::to_string(done) + " éléments écrits sur " + std::to_string(total));
+            out.close();
+            if (!out)
+                throw std::runtime_error("Erreur d'écriture du fichier .npy");
+        }
+
+    private:
+        std::ofstream out;
+        size_t total;
+        size_t done = 0;
+    };
+
+    /**
+     * Écrit une archive .npz (ZIP sans compression, ZIP64 au-delà de 4 Go), lisible par numpy.load.
+     * Chaque tableau est écrit directement dans le fichier ; ses données sont alignées sur 64 octets
+     * pour pouvoir être rechargées en mode LoadMode::map.
+     */
+    class NpzWriter
+    {
+    public:
+        explicit NpzWriter(const std::string &path) : out(path, std::ios::binary | std::ios::trunc)
+        {
+            if (!out)
+                throw std::runtime_error("Impossible de créer le fichier " + path);
+        }
+        ~NpzWriter()
+        {
+            try
+            {
+                if (out.is_open())
+                    close();
+            }
+            catch (...)
+            {
+            }
+        }
+        NpzWriter(const NpzWriter &) = delete;
+        NpzWriter &operator=(const NpzWriter &) = delete;
+
+        template <typename T>
+        void add(const std::string &name, const NDarray<T> &arr)
+        {
+            NDarray<T> c = arr.contiguous();
+            std::string header = detail::make_npy_header(detail::npy_descr<T>(), c.getShape());
+            uint64_t nbytes = static_cast<uint64_t>(c.getSize()) * sizeof(T);
+            Entry e{name + ".npy", 0, header.size() + nbytes, static_cast<uint64_t>(out.tellp())};
+            bool zip64 = e.size >= 0xffffffff;
+
+            // En-tête local ; le CRC est complété une fois les données écrites
+            std::string local;
+            detail::put_le(local, 0x04034b50, 4);
+            detail::put_le(local, zip64 ? 45 : 20, 2);
+            detail::put_le(local, 0, 2);
+            detail::put_le(local, 0, 2);  // Stocké
+            detail::put_le(local, 0, 2);  // Heure
+            detail::put_le(local, 33, 2); // Date : 1er janvier 1980
+            detail::put_le(local, 0, 4);
+            detail::put_le(local, zip64 ? 0xffffffff : e.size, 4);
+            detail::put_le(local, zip64 ? 0xffffffff : e.size, 4);
+            detail::put_le(local, e.name.size(), 2);
+            size_t extra = zip64 ? 20 : 0;
+            size_t fixed = 30 + e.name.size() + extra;
+            size_t pad = (64 - (e.offset + fixed + 4) % 64) % 64; // Champ de bourrage pour aligner les données
+            detail::put_le(local, extra + 4 + pad, 2);
+            local += e.name;
+            if (zip64)
+            {
+                detail::put_le(local, 0x0001, 2);
+                detail::put_le(local, 16, 2);
+                detail::put_le(local, e.size, 8);
+                detail::put_le(local, e.size, 8);
+            }
+            detail::put_le(local, 0xd935, 2);
+            detail::put_le(local, pad, 2);
+            local.append(pad, '\0');
+            out.write(local.data(), static_cast<std::streamsize>(local.size()));
+
+            out.write(header.data(), static_cast<std::streamsize>(header.size()));
+            e.crc = detail::crc32(0, header.data(), header.size());
+            const char *p = reinterpret_cast<const char *>(c.data());
+            for (uint64_t done = 0; done < nbytes;)
+            {
+                size_t len = static_cast<size_t>(std::min<uint64_t>(nbytes - done, 1 << 24));
+                e.crc = detail::crc32(e.crc, p + done, len);
+                out.write(p + done, static_cast<std::streamsize>(len));
+                done += len;
+            }
+            std::streampos end = out.tellp();
+            std::string crc;
+            detail::put_le(crc, e.crc, 4);
+            out.seekp(static_cast<std::streamoff>(e.offset + 14));
+            out.write(crc.data(), 4);
+            out.seekp(end);
+            if (!out)
+                throw std::runtime_error("Erreur d'écriture de l'archive .npz");
+            entries.push_back(std::move(e));
+        }
+
+        // Écrit le répertoire central et ferme l'archive
+        void close()
+        {
+            uint64_t cd_pos = static_cast<uint64_t>(out.tellp());
+            std::string cd;
+            for (const Entry &e : entries)
+            {
+                bool big_size = e.size >= 0xffffffff, big_offset = e.offset >= 0xffffffff;
+                std::string extra;
+                if (big_size || big_offset)
+                {
+                    detail::put_le(extra, 0x0001, 2);
+                    detail::put_le(extra, (big_size ? 16 : 0) + (big_offset ? 8 : 0), 2);
+                    if (big_size)
+                    {
+                        detail::put_le(extra, e.size, 8);
+                        detail::put_le(extra, e.size, 8);
+                    }
+                    if (big_offset)
+                        detail::put_le(extra, e.offset, 8);
+                }
+                detail::put_le(cd, 0x02014b50, 4);
+                detail::put_le(cd, 45, 2);
+                detail::put_le(cd, extra.empty() ? 20 : 45, 2);
+                detail::put_le(cd, 0, 2);
+                detail::put_le(cd, 0, 2);
+                detail::put_le(cd, 0, 2);
+                detail::put_le(cd, 33, 2);
+                detail::put_le(cd, e.crc, 4);
+                detail::put_le(cd, big_size ? 0xffffffff : e.size, 4);
+                detail::put_le(cd, big_size ? 0xffffffff : e.size, 4);
+                detail::put_le(cd, e.name.size(), 2);
+                detail::put_le(cd, extra.size(), 2);
+                detail::put_le(cd, 0, 2); // Commentaire
+                detail::put_le(cd, 0, 2); // Disque
+                detail::put_le(cd, 0, 2); // Attributs internes
+                detail::put_le(cd, 0x81a40000, 4); // Fichier régulier rw-r--r--
+                detail::put_le(cd, big_offset ? 0xffffffff : e.offset, 4);
+                cd += e.name;
+                cd += extra;
+            }
+            uint64_t count = entries.size(), cd_size = cd.size();
+            std::string tail;
+            if (count >= 0xffff || cd_pos >= 0xffffffff || cd_size >= 0xffffffff)
+            {
+                uint64_t rec_pos = cd_pos + cd_size;
+                detail::put_le(tail, 0x06064b50, 4);
+                detail::put_le(tail, 44, 8);
+                detail::put_le(tail, 45, 2);
+                detail::put_le(tail, 45, 2);
+                detail::put_le(tail, 0, 4);
+                detail::put_le(tail, 0, 4);
+                detail::put_le(tail, count, 8);
+                detail::put_le(tail, count, 8);
+                detail::put_le(tail, cd_size, 8);
+                detail::put_le(tail, cd_pos, 8);
+                detail::put_le(tail, 0x07064b50, 4);
+                detail::put_le(tail, 0, 4);
+                detail::put_le(tail, rec_pos, 8);
+                detail::put_le(tail, 1, 4);
+            }
+            detail::put_le(tail, 0x06054b50, 4);
+            detail::put_le(tail, 0, 4);
+            detail::put_le(tail, std::min<uint64_t>(count, 0xffff), 2);
+            detail::put_le(tail, std::min<uint64_t>(count, 0xffff), 2);
+            detail::put_le(tail, std::min<uint64_t>(cd_size, 0xffffffff), 4);
+            detail::put_le(tail, std::min<uint64_t>(cd_pos, 0xffffffff), 4);
+            detail::put_le(tail, 0, 2);
+            out.write(cd.data(), static_cast<std::streamsize>(cd.size()));
+            out.write(tail.data(), static_cast<std::streamsize>(tail.size()));
+            out.close();
+            if (!out)
+                throw std::runtime_error("Erreur d'écriture de l'archive .npz");
+        }
+
+    private:
+        struct Entry
+        {
+            std::string name;
+            uint32_t crc;
+            uint64_t size;   // En-tête .npy compris
+            uint64_t offset; // Position de l'en-tête local
+        };
+        std::ofstream out;
+        std::vector<Entry> entries;
+    };
+}
+
+#endif
@@ -0,0 +1,547 @@
+#ifndef NDARRAY_MEMORY_H
+#define NDARRAY_MEMORY_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Allocation des tampons de NDarray : pool aligné par classes de taille, arènes et compteurs
+namespace nd
+{
+    // Alignement de tous les tampons (une ligne de cache, un registre AVX-512)
+    constexpr size_t buffer_alignment = 64;
+
+    /**
+     * Politique d'allocation des tampons. Une implémentation doit renvoyer une mémoire alignée
+     * sur buffer_alignment octets ; deallocate reçoit la taille demandée à allocate.
+     */
+    class Allocator
+    {
+    public:
+        virtual ~Allocator() = default;
+        virtual void *allocate(size_t bytes) = 0;
+        virtual void deallocate(void *p, size_t bytes) noexcept = 0;
+    };
+
+    // Compteurs d'allocation des tampons de NDarray
+    struct MemoryStats
+    {
+        uint64_t allocations = 0;     // Nombre de tampons alloués
+        uint64_t bytes_allocated = 0; // Octets alloués depuis le début (cumul)
+        size_t bytes_in_use = 0;      // Octets des tampons vivants
+        size_t peak_bytes = 0;        // Maximum de bytes_in_use (à in_use_slack octets par thread près)
+        uint64_t pool_requests = 0;   // Demandes servies par le pool
+        uint64_t pool_hits = 0;       // Demandes satisfaites par un tampon recyclé
+        size_t bytes_cached = 0;      // Octets conservés par le pool pour être recyclés
+
+        double hit_rate() const { return pool_requests ? static_cast<double>(pool_hits) / pool_requests : 0.0; }
+    };
+
+    // Écart d'utilisation accumulé par un thread avant d'être reporté dans le total partagé qui sert au pic
+    constexpr int64_t in_use_slack = int64_t(256) << 10;
+
+    namespace detail
+    {
+        inline void *aligned_new(size_t bytes)
+        {
+            return ::operator new(bytes, std::align_val_t(buffer_alignment));
+        }
+        inline void aligned_delete(void *p) noexcept
+        {
+            ::operator delete(p, std::align_val_t(buffer_alignment));
+        }
+
+        /**
+         * Compteurs tenus par chaque thread (sans instruction atomique coûteuse ni ligne de cache partagée)
+         * et additionnés à la lecture ; ceux d'un thread terminé sont reportés dans le total des threads finis.
+         */
+        enum Counter
+        {
+            count_allocations,
+            count_bytes,
+            count_pool_requests,
+            count_pool_hits,
+            count_thread_cached,
+            count_in_use,
+            num_counters
+        };
+
+        /**
+         * Utilisation reportée par les threads et pic de cette valeur. Chaque thread n'y reporte son écart
+         * que lorsqu'il dépasse in_use_slack : les petits tampons ne touchent pas de ligne de cache partagée.
+         */
+        inline std::atomic<int64_t> stat_flushed{0};
+        inline std::atomic<int64_t> stat_peak{0};
+
+        inline void flush_in_use(int64_t delta)
+        {
+            int64_t now = stat_flushed.fetch_add(delta, std::memory_order_relaxed) + delta;
+            int64_t peak = stat_peak.load(std::memory_order_relaxed);
+            while (now > peak && !stat_peak.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+            {
+            }
+        }
+        struct CounterRegistry
+        {
+            std::mutex mutex;
+            std::vector<std::atomic<int64_t> *> live;
+            int64_t retired[num_counters] = {};
+
+            static CounterRegistry &instance()
+            {
+                static CounterRegistry *r = new CounterRegistry(); // Jamais détruit : utilisable jusqu'à la fin du programme
+                return *r;
+            }
+        };
+        struct ThreadCounters
+        {
+            std::atomic<int64_t> v[num_counters] = {};
+            int64_t pending = 0; // Écart d'utilisation pas encore reporté dans stat_flushed
+            ThreadCounters()
+            {
+                CounterRegistry &r = CounterRegistry::instance();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.live.push_back(v);
+            }
+            ~ThreadCounters()
+            {
+                flush_in_use(pending);
+                CounterRegistry &r = CounterRegistry::instance();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                for (size_t i = 0; i < num_counters; ++i)
+                    r.retired[i] += v[i].load(std::memory_order_relaxed);
+                r.live.erase(std::find(r.live.begin(), r.live.end(), v));
+            }
+            // Seul le thread propriétaire écrit : pas besoin d'incrément atomique
+            void add(Counter c, int64_t x) { v[c].store(v[c].load(std::memory_order_relaxed) + x, std::memory_order_relaxed); }
+            // Tampon de bytes octets créé (bytes > 0) ou libéré (bytes < 0) par ce thread
+            void in_use(int64_t bytes)
+            {
+                add(count_in_use, bytes);
+                pending += bytes;
+                if (pending > in_use_slack || pending < -in_use_slack)
+                {
+                    flush_in_use(pending);
+                    pending = 0;
+                }
+            }
+        };
+        inline ThreadCounters &counters()
+        {
+            static thread_local ThreadCounters c;
+            return c;
+        }
+        inline int64_t counter_total(Counter c)
+        {
+            CounterRegistry &r = CounterRegistry::instance();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            int64_t total = r.retired[c];
+            for (std::atomic<int64_t> *v : r.live)
+                total += v[c].load(std::memory_order_relaxed);
+            return total;
+        }
+    }
+
+    /**
+     * Pool par classes de taille : quatre classes par puissance de deux (perte d'au plus 25 %).
+     * Chaque thread garde un petit cache sans verrou pour les classes jusqu'à 1 Mo ; au-delà, ou quand
+     * ce cache est plein, les blocs libres vont dans une liste par classe protégée par un verrou.
+     * Un tampon libéré est gardé pour la prochaine demande de la même classe tant que le cache
+     * partagé reste sous sa limite. Le pool n'est jamais détruit.
+     */
+    class PoolAllocator : public Allocator
+    {
+        struct Block
+        {
+            Block *next;
+        };
+
+    public:
+        static PoolAllocator &instance()
+        {
+            static PoolAllocator *pool = new PoolAllocator();
+            return *pool;
+        }
+
+        void *allocate(size_t bytes) override { return allocate(bytes, true); }
+
+        // counted : faux pour les allocations internes, qui n'entrent pas dans les compteurs
+        void *allocate(size_t bytes, bool counted)
+        {
+            size_t c = size_class(bytes);
+            detail::ThreadCounters &cnt = detail::counters();
+            if (counted)
+                cnt.add(detail::count_pool_requests, 1);
+            if (c < thread_classes)
+            {
+                ThreadCache &tc = thread_cache();
+                if (Block *b = tc.head[c])
+                {
+                    tc.head[c] = b->next;
+                    --tc.count[c];
+                    cnt.add(detail::count_thread_cached, -static_cast<int64_t>(class_size(c)));
+                    if (counted)
+                        cnt.add(detail::count_pool_hits, 1);
+                    return b;
+                }
+            }
+            if (c < num_classes)
+            {
+                Class &cl = classes[c];
+                std::lock_guard<std::mutex> lock(cl.mutex);
+                if (Block *b = cl.head)
+                {
+                    cl.head = b->next;
+                    cached.fetch_sub(class_size(c), std::memory_order_relaxed);
+                    if (counted)
+                        cnt.add(detail::count_pool_hits, 1);
+                    return b;
+                }
+            }
+            return detail::aligned_new(c < num_classes ? class_size(c) : bytes);
+        }
+
+        void deallocate(void *p, size_t bytes) noexcept override
+        {
+            size_t c = size_class(bytes);
+            if (c < thread_classes)
+            {
+                ThreadCache &tc = thread_cache();
+                if (tc.count[c] < thread_blocks)
+                {
+                    Block *b = static_cast<Block *>(p);
+                    b->next = tc.head[c];
+                    tc.head[c] = b;
+                    ++tc.count[c];
+                    detail::counters().add(detail::count_thread_cached, static_cast<int64_t>(class_size(c)));
+                    return;
+                }
+            }
+            give_back(p, c);
+        }
+
+        // Octets au-delà desquels les tampons libérés sont rendus au système (256 Mo par défaut)
+        void set_cache_limit(size_t bytes) { limit = bytes; }
+        size_t cache_limit() const { return limit; }
+        // Octets conservés, caches des threads compris
+        size_t bytes_cached() const { return cached + static_cast<size_t>(std::max<int64_t>(0, detail::counter_total(detail::count_thread_cached))); }
+
+        // Rend au système les tampons du cache partagé et de celui du thread appelant
+        void release() noexcept
+        {
+            thread_cache().flush();
+            for (size_t c = 0; c < num_classes; ++c)
+            {
+                std::lock_guard<std::mutex> lock(classes[c].mutex);
+                while (Block *b = classes[c].head)
+                {
+                    classes[c].head = b->next;
+                    cached.fetch_sub(class_size(c), std::memory_order_relaxed);
+                    detail::aligned_delete(b);
+                }
+            }
+        }
+
+        // Classe de taille de bytes (num_classes au-delà de la plus grande classe)
+        static size_t size_class(size_t bytes)
+        {
+            if (bytes <= buffer_alignment)
+                return 0;
+            size_t p = 63 - static_cast<size_t>(__builtin_clzll(static_cast<unsigned long long>(bytes - 1))); // 2^p < bytes <= 2^(p+1)
+            size_t step = size_t(1) << (p - 2);
+            size_t q = (bytes + step - 1) / step; // 5 à 8 quarts de 2^p
+            return std::min<size_t>(1 + (p - 6) * 4 + (q - 5), num_classes);
+        }
+        static size_t class_size(size_t c)
+        {
+            if (c == 0)
+                return buffer_alignment;
+            size_t p = (c - 1) / 4 + 6, q = (c - 1) % 4 + 5;
+            return q << (p - 2);
+        }
+
+    private:
+        PoolAllocator() = default;
+
+        static constexpr size_t num_classes = 1 + 4 * 30;    // Jusqu'à 64 Go
+        static constexpr size_t thread_classes = 1 + 4 * 14; // Jusqu'à 1 Mo dans le cache des threads
+        static constexpr size_t thread_blocks = 4;           // Blocs gardés par classe et par thread
+
+        struct Class
+        {
+            std::mutex mutex;
+            Block *head = nullptr;
+        };
+
+        struct ThreadCache
+        {
+            Block *head[thread_classes] = {};
+            size_t count[thread_classes] = {};
+            ThreadCache() { detail::counters(); } // Les compteurs du thread doivent être détruits après le cache
+            void flush() noexcept
+            {
+                for (size_t c = 0; c < thread_classes; ++c)
+                    while (Block *b = head[c])
+                    {
+                        head[c] = b->next;
+                        --count[c];
+                        detail::counters().add(detail::count_thread_cached, -static_cast<int64_t>(class_size(c)));
+                        instance().give_back(b, c);
+                    }
+            }
+            ~ThreadCache() { flush(); }
+        };
+        static ThreadCache &thread_cache()
+        {
+            static thread_local ThreadCache tc;
+            return tc;
+        }
+
+        void give_back(void *p, size_t c) noexcept
+        {
+            if (c < num_classes && cached.load(std::memory_order_relaxed) + class_size(c) <= limit.load(std::memory_order_relaxed))
+            {
+                Class &cl = classes[c];
+                std::lock_guard<std::mutex> lock(cl.mutex);
+                Block *b = static_cast<Block *>(p);
+                b->next = cl.head;
+                cl.head = b;
+                cached.fetch_add(class_size(c), std::memory_order_relaxed);
+                return;
+            }
+            detail::aligned_delete(p);
+        }
+
+        Class classes[num_classes];
+        std::atomic<size_t> cached{0};
+        std::atomic<size_t> limit{size_t(256) << 20};
+    };
+
+    /**
+     * Arène : allocation par simple avancée d'un pointeur dans de grands blocs, libération gratuite.
+     * Quand tous les tampons de l'arène ont été libérés, elle revient au début de son premier bloc :
+     * une arène réutilisée d'un lot de requêtes à l'autre n'alloue plus rien une fois chauffée.
+     * Les tampons gardent l'arène en vie : un résultat peut survivre au lot qui l'a produit.
+     */
+    class Arena : public Allocator
+    {
+    public:
+        explicit Arena(size_t chunk_bytes = size_t(16) << 20) : chunk(std::max(chunk_bytes, buffer_alignment)) {}
+        ~Arena() override
+        {
+            for (Chunk &c : chunks)
+                detail::aligned_delete(c.base);
+        }
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        void *allocate(size_t bytes) override
+        {
+            bytes = (std::max<size_t>(bytes, 1) + buffer_alignment - 1) / buffer_alignment * buffer_alignment;
+            std::lock_guard<std::mutex> lock(mutex);
+            while (current < chunks.size() && chunks[current].size - used < bytes)
+            {
+                ++current; // Bloc plein : on passe au suivant
+                used = 0;
+            }
+            if (current == chunks.size())
+            {
+                size_t size = std::max(chunk, bytes);
+                chunks.push_back(Chunk{static_cast<char *>(detail::aligned_new(size)), size});
+                used = 0;
+            }
+            void *p = chunks[current].base + used;
+            used += bytes;
+            ++live;
+            return p;
+        }
+
+        void deallocate(void *, size_t) noexcept override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--live == 0)
+            {
+                current = 0;
+                used = 0;
+            }
+        }
+
+        // Octets réservés par l'arène
+        size_t capacity() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t total = 0;
+            for (const Chunk &c : chunks)
+                total += c.size;
+            return total;
+        }
+
+    private:
+        struct Chunk
+        {
+            char *base;
+            size_t size;
+        };
+        size_t chunk;
+        std::vector<Chunk> chunks;
+        size_t current = 0, used = 0, live = 0;
+        mutable std::mutex mutex;
+    };
+
+    namespace detail
+    {
+        // Allocateur global : nullptr désigne le pool intégré
+        inline std::shared_ptr<Allocator> global_allocator;
+        inline std::atomic<bool> custom_global{false};
+        inline std::mutex global_allocator_mutex;
+        inline thread_local std::shared_ptr<Allocator> scoped_allocator;
+    }
+
+    // Remplace l'allocateur utilisé par défaut par tous les threads (nullptr : pool intégré)
+    inline void set_allocator(std::shared_ptr<Allocator> alloc)
+    {
+        std::lock_guard<std::mutex> lock(detail::global_allocator_mutex);
+        detail::custom_global = alloc != nullptr;
+        detail::global_allocator = std::move(alloc);
+    }
+
+    // Allocateur utilisé pour les nouveaux tampons créés depuis ce thread (nullptr : pool intégré)
+    inline std::shared_ptr<Allocator> current_allocator()
+    {
+        if (detail::scoped_allocator)
+            return detail::scoped_allocator;
+        if (!detail::custom_global.load(std::memory_order_acquire))
+            return nullptr;
+        std::lock_guard<std::mutex> lock(detail::global_allocator_mutex);
+        return detail::global_allocator;
+    }
+
+    // Utilise alloc pour les tampons créés depuis le thread courant, le temps d'une portée
+    class ScopedAllocator
+    {
+    public:
+        explicit ScopedAllocator(std::shared_ptr<Allocator> alloc) : previous(std::move(detail::scoped_allocator))
+        {
+            detail::scoped_allocator = std::move(alloc);
+        }
+        ~ScopedAllocator() { detail::scoped_allocator = std::move(previous); }
+        ScopedAllocator(const ScopedAllocator &) = delete;
+        ScopedAllocator &operator=(const ScopedAllocator &) = delete;
+
+    private:
+        std::shared_ptr<Allocator> previous;
+    };
+
+    /**
+     * Arène active le temps d'une portée, pour les temporaires d'un lot :
+     *     nd::ScopedArena batch;         // nouvelle arène
+     *     nd::ScopedArena batch(arena);  // arène conservée et réutilisée d'un lot à l'autre
+     */
+    class ScopedArena
+    {
+    public:
+        explicit ScopedArena(size_t chunk_bytes = size_t(16) << 20) : ScopedArena(std::make_shared<Arena>(chunk_bytes)) {}
+        explicit ScopedArena(std::shared_ptr<Arena> a) : arena_(std::move(a)), scope(arena_) {}
+        const std::shared_ptr<Arena> &arena() const { return arena_; }
+
+    private:
+        std::shared_ptr<Arena> arena_;
+        ScopedAllocator scope;
+    };
+
+    // Compteurs courants ; les compteurs du pool concernent le pool intégré
+    inline MemoryStats memory_stats()
+    {
+        MemoryStats s;
+        s.allocations = static_cast<uint64_t>(detail::counter_total(detail::count_allocations));
+        s.bytes_allocated = static_cast<uint64_t>(detail::counter_total(detail::count_bytes));
+        s.bytes_in_use = static_cast<size_t>(std::max<int64_t>(0, detail::counter_total(detail::count_in_use)));
+        s.peak_bytes = std::max(s.bytes_in_use, static_cast<size_t>(std::max<int64_t>(0, detail::stat_peak)));
+        s.pool_requests = static_cast<uint64_t>(detail::counter_total(detail::count_pool_requests));
+        s.pool_hits = static_cast<uint64_t>(detail::counter_total(detail::count_pool_hits));
+        s.bytes_cached = PoolAllocator::instance().bytes_cached();
+        return s;
+    }
+
+    // Ramène le pic d'utilisation à l'utilisation courante
+    inline void reset_peak_memory() { detail::stat_peak = detail::stat_flushed.load(); }
+
+    namespace detail
+    {
+        // Rend un tampon à son allocateur (owner vide : pool intégré), en détruisant les éléments si nécessaire
+        template <typename T>
+        struct BufferDeleter
+        {
+            std::shared_ptr<Allocator> owner;
+            size_t count;
+            void operator()(T *p) const noexcept
+            {
+                if constexpr (!std::is_trivially_destructible<T>::value)
+                    for (size_t i = 0; i < count; ++i)
+                        p[i].~T();
+                counters().in_use(-static_cast<int64_t>(count * sizeof(T)));
+                if (owner)
+                    owner->deallocate(p, count * sizeof(T));
+                else
+                    PoolAllocator::instance().deallocate(p, count * sizeof(T));
+            }
+        };
+
+        // Allocateur standard pour le bloc de contrôle des shared_ptr : servi par le pool, hors compteurs
+        template <typename U>
+        struct ControlAllocator
+        {
+            using value_type = U;
+            ControlAllocator() = default;
+            template <typename V>
+            ControlAllocator(const ControlAllocator<V> &) {}
+            U *allocate(size_t n) { return static_cast<U *>(PoolAllocator::instance().allocate(n * sizeof(U), false)); }
+            void deallocate(U *p, size_t n) noexcept { PoolAllocator::instance().deallocate(p, n * sizeof(U)); }
+            template <typename V>
+            bool operator==(const ControlAllocator<V> &) const { return true; }
+            template <typename V>
+            bool operator!=(const ControlAllocator<V> &) const { return false; }
+        };
+
+        // Alloue un tampon aligné de n éléments avec l'allocateur courant (non initialisés si T est trivial)
+        template <typename T>
+        std::shared_ptr<T[]> allocate_buffer(size_t n)
+        {
+            static_assert(alignof(T) <= buffer_alignment, "Alignement du type d'élément trop grand");
+            n = std::max<size_t>(n, 1);
+            std::shared_ptr<Allocator> owner = current_allocator();
+            Allocator &alloc = owner ? *owner : PoolAllocator::instance();
+            size_t bytes = n * sizeof(T);
+            T *p = static_cast<T *>(alloc.allocate(bytes));
+            if constexpr (!std::is_trivially_default_constructible<T>::value)
+            {
+                size_t i = 0;
+                try
+                {
+                    for (; i < n; ++i)
+                        new (p + i) T();
+                }
+                catch (...)
+                {
+                    while (i > 0)
+                        p[--i].~T();
+                    alloc.deallocate(p, bytes);
+                    throw;
+                }
+            }
+            ThreadCounters &cnt = counters();
+            cnt.add(count_allocations, 1);
+            cnt.add(count_bytes, static_cast<int64_t>(bytes));
+            cnt.in_use(static_cast<int64_t>(bytes));
+            return std::shared_ptr<T[]>(p, BufferDeleter<T>{std::move(owner), n}, ControlAllocator<T>());
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,290 @@
+#ifndef NDARRAY_PARALLEL_H
+#define NDARRAY_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Outils de parallélisation utilisés par les noyaux de calcul de NDarray
+namespace nd
+{
+    namespace detail
+    {
+        inline std::atomic<size_t> global_threads{0};       // 0 : un thread par cœur
+        inline std::atomic<size_t> global_threshold{65536}; // Taille minimale d'un travail parallèle élément par élément
+        inline thread_local size_t scoped_threads = 0;      // Réglage propre au thread appelant (ScopedThreads)
+        inline thread_local bool in_parallel = false;       // Vrai pendant l'exécution d'un bloc parallèle
+
+        // Nombre d'éléments traités au minimum par chaque bloc d'une boucle élément par élément
+        constexpr size_t elementwise_grain = 32768;
+    }
+
+    // Nombre de cœurs de la machine
+    inline size_t hardware_threads()
+    {
+        size_t n = std::thread::hardware_concurrency();
+        return n > 0 ? n : 1;
+    }
+
+    // Fixe le nombre de threads utilisés par défaut par tous les noyaux parallèles (0 : un par cœur)
+    inline void set_num_threads(size_t n) { detail::global_threads = n; }
+
+    // Nombre de threads utilisés par les noyaux parallèles appelés depuis ce thread
+    inline size_t num_threads()
+    {
+        size_t n = detail::scoped_threads ? detail::scoped_threads : detail::global_threads.load();
+        return n > 0 ? n : hardware_threads();
+    }
+
+    // Fixe le nombre d'éléments en dessous duquel le travail élément par élément reste séquentiel
+    inline void set_parallel_threshold(size_t n) { detail::global_threshold = n; }
+    inline size_t parallel_threshold() { return detail::global_threshold; }
+
+    /**
+     * Limite le nombre de threads des appels faits depuis le thread courant, le temps d'une portée :
+     *     { nd::ScopedThreads guard(4); c = nd::eval(a + b); }
+     * Les autres threads de l'application gardent leur propre réglage.
+     */
+    class ScopedThreads
+    {
+    public:
+        explicit ScopedThreads(size_t n) : previous(detail::scoped_threads) { detail::scoped_threads = n; }
+        ~ScopedThreads() { detail::scoped_threads = previous; }
+        ScopedThreads(const ScopedThreads &) = delete;
+        ScopedThreads &operator=(const ScopedThreads &) = delete;
+
+    private:
+        size_t previous;
+    };
+
+    namespace detail
+    {
+        /**
+         * Travail soumis au pool : nblocks blocs répartis en tranches contiguës, une par participant.
+         * Chaque participant dépile ses blocs par l'avant, puis vole ceux des autres par l'arrière.
+         * Une tranche [lo, hi) est codée dans un seul mot atomique (lo sur les 32 bits de poids fort).
+         */
+        struct Job
+        {
+            void (*call)(void *, size_t, size_t);
+            void *fn;
+            size_t begin, end, block;
+            size_t nslots;
+            size_t next_slot = 1; // Le participant 0 est le thread appelant (protégé par le mutex du pool)
+            std::unique_ptr<std::atomic<uint64_t>[]> slices;
+            std::atomic<size_t> remaining;
+            std::atomic<bool> failed{false};
+            std::exception_ptr error;
+            std::mutex mutex;
+            std::condition_variable done;
+
+            Job(void (*c)(void *, size_t, size_t), void *f, size_t b, size_t e, size_t nblocks, size_t slots)
+                : call(c), fn(f), begin(b), end(e), block((e - b + nblocks - 1) / nblocks),
+                  nslots(slots), slices(new std::atomic<uint64_t>[slots]), remaining(nblocks)
+            {
+                for (size_t s = 0; s < slots; ++s)
+                    slices[s] = pack(nblocks * s / slots, nblocks * (s + 1) / slots);
+            }
+
+            static uint64_t pack(size_t lo, size_t hi) { return (static_cast<uint64_t>(lo) << 32) | hi; }
+
+            // Prend le premier bloc de la tranche s (from_back : le dernier)
+            bool take(size_t s, bool from_back, size_t &b)
+            {
+                uint64_t v = slices[s].load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    size_t lo = static_cast<size_t>(v >> 32), hi = static_cast<size_t>(v & 0xffffffffu);
+                    if (lo >= hi)
+                        return false;
+                    uint64_t next = from_back ? pack(lo, hi - 1) : pack(lo + 1, hi);
+                    if (slices[s].compare_exchange_weak(v, next, std::memory_order_acq_rel))
+                    {
+                        b = from_back ? hi - 1 : lo;
+                        return true;
+                    }
+                }
+            }
+
+            void execute(size_t b)
+            {
+                if (!failed.load(std::memory_order_relaxed))
+                {
+                    size_t lo = begin + b * block, hi = std::min(end, lo + block);
+                    try
+                    {
+                        if (lo < hi)
+                            call(fn, lo, hi);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!error)
+                            error = std::current_exception();
+                        failed = true;
+                    }
+                }
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    done.notify_all();
+                }
+            }
+
+            // Exécute les blocs du participant s puis vole ceux des autres jusqu'à épuisement
+            void run(size_t s)
+            {
+                bool outer = in_parallel;
+                in_parallel = true;
+                size_t b;
+                while (take(s, false, b))
+                    execute(b);
+                for (size_t k = 1; k < nslots; ++k)
+                    while (take((s + k) % nslots, true, b))
+                        execute(b);
+                in_parallel = outer;
+            }
+
+            void wait()
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                done.wait(lock, [this]()
+                          { return remaining.load(std::memory_order_acquire) == 0; });
+            }
+        };
+
+        /**
+         * Pool de threads partagé par toute la bibliothèque. Les threads sont créés à la demande,
+         * jusqu'au plus grand nombre de participants demandé, et vivent jusqu'à la fin du programme.
+         * Plusieurs threads de l'application peuvent soumettre des travaux simultanément.
+         */
+        class ThreadPool
+        {
+        public:
+            static ThreadPool &instance()
+            {
+                static ThreadPool pool;
+                return pool;
+            }
+
+            ~ThreadPool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stop = true;
+                }
+                wake.notify_all();
+                for (std::thread &w : workers)
+                    w.join();
+            }
+
+            // Exécute job avec l'aide d'au plus job.nslots - 1 threads du pool, puis relance sa première exception
+            void run(const std::shared_ptr<Job> &job)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    while (workers.size() + 1 < job->nslots)
+                        workers.emplace_back([this]()
+                                             { loop(); });
+                    jobs.push_back(job);
+                }
+                for (size_t s = 1; s < job->nslots; ++s)
+                    wake.notify_one();
+                job->run(0);
+                job->wait();
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    auto it = std::find(jobs.begin(), jobs.end(), job);
+                    if (it != jobs.end())
+                        jobs.erase(it);
+                }
+                if (job->error)
+                    std::rethrow_exception(job->error);
+            }
+
+        private:
+            ThreadPool() = default;
+
+            void loop()
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                for (;;)
+                {
+                    wake.wait(lock, [this]()
+                              { return stop || !jobs.empty(); });
+                    if (stop)
+                        return;
+                    std::shared_ptr<Job> job = jobs.front();
+                    size_t s = job->next_slot++;
+                    if (job->next_slot >= job->nslots)
+                        jobs.pop_front(); // Toutes les places sont prises
+                    lock.unlock();
+                    job->run(s);
+                    lock.lock();
+                }
+            }
+
+            std::mutex mutex;
+            std::condition_variable wake;
+            std::deque<std::shared_ptr<Job>> jobs;
+            std::vector<std::thread> workers;
+            bool stop = false;
+        };
+    }
+
+    /**
+     * Découpe l'intervalle [begin, end) en blocs d'au moins grain éléments et appelle
+     * fn(lo, hi) sur chaque bloc, en parallèle sur le pool lorsque l'intervalle est assez grand.
+     * Les blocs sont plus nombreux que les threads pour que le vol de travail équilibre la charge.
+     * Un appel imbriqué (depuis un bloc déjà parallèle) s'exécute séquentiellement.
+     * La première exception levée par un bloc est relancée dans le thread appelant.
+     */
+    template <typename F>
+    void parallel_for(size_t begin, size_t end, size_t grain, F &&fn)
+    {
+        if (end <= begin)
+            return;
+        size_t n = end - begin;
+        grain = std::max<size_t>(grain, 1);
+        size_t threads = detail::in_parallel ? 1 : num_threads();
+        size_t nblocks = std::min(4 * threads, (n + grain - 1) / grain);
+        if (threads <= 1 || nblocks <= 1)
+        {
+            fn(begin, end);
+            return;
+        }
+        using Fn = std::remove_reference_t<F>;
+        auto call = [](void *f, size_t lo, size_t hi)
+        { (*static_cast<Fn *>(f))(lo, hi); };
+        auto job = std::make_shared<detail::Job>(call, const_cast<void *>(static_cast<const void *>(&fn)),
+                                                 begin, end, nblocks, std::min(threads, nblocks));
+        detail::ThreadPool::instance().run(job);
+    }
+
+    /**
+     * Boucle élément par élément sur units unités de unit_size éléments chacune (lignes, blocs...).
+     * Reste séquentielle tant que le nombre total d'éléments est sous parallel_threshold().
+     */
+    template <typename F>
+    void parallel_for_elements(size_t units, size_t unit_size, F &&fn)
+    {
+        unit_size = std::max<size_t>(unit_size, 1);
+        if (units * unit_size < parallel_threshold())
+        {
+            if (units > 0)
+                fn(size_t(0), units);
+            return;
+        }
+        parallel_for(0, units, std::max<size_t>(1, detail::elementwise_grain / unit_size), std::forward<F>(fn));
+    }
+}
+
+#endif
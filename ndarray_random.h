@@ -0,0 +1,490 @@
+#ifndef NDARRAY_RANDOM_H
+#define NDARRAY_RANDOM_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "ndarray_fwd.h"
+#include "ndarray_expr.h"
+#include "ndarray_gemm.h"
+#include "ndarray_instrument.h"
+#include "ndarray_parallel.h"
+
+#ifdef NDARRAY_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+// Génération de nombres aléatoires : moteur à compteur Philox4x32-10 (Salmon et al., 2011)
+// Le bloc de 128 bits numéro i d'un flux est une fonction pure de (graine, flux, i) : un
+// remplissage attribue à chaque élément un bloc fixé par sa position, si bien que le résultat
+// ne dépend ni du nombre de threads ni du découpage du travail.
+namespace nd
+{
+    namespace detail
+    {
+        constexpr uint32_t philox_m0 = 0xD2511F53u; // Multiplicateurs
+        constexpr uint32_t philox_m1 = 0xCD9E8D57u;
+        constexpr uint32_t philox_w0 = 0x9E3779B9u; // Incréments de la clé (nombre d'or, sqrt(3) - 1)
+        constexpr uint32_t philox_w1 = 0xBB67AE85u;
+        constexpr size_t philox_group = 16;  // Blocs calculés ensemble ; unité de consommation des remplissages
+        constexpr size_t group_words = 4 * philox_group;
+        constexpr size_t random_chunk = 16; // Groupes générés à la fois dans un tampon local (4 Ko)
+
+        // Bloc de 128 bits numéro ctr du flux stream sous la clé key : 10 tours de Philox4x32
+        inline void philox_block(uint64_t key, uint64_t stream, uint64_t ctr, uint32_t out[4])
+        {
+            uint32_t c0 = static_cast<uint32_t>(ctr), c1 = static_cast<uint32_t>(ctr >> 32);
+            uint32_t c2 = static_cast<uint32_t>(stream), c3 = static_cast<uint32_t>(stream >> 32);
+            uint32_t k0 = static_cast<uint32_t>(key), k1 = static_cast<uint32_t>(key >> 32);
+            for (int r = 0; r < 10; ++r)
+            {
+                uint64_t p0 = static_cast<uint64_t>(philox_m0) * c0;
+                uint64_t p1 = static_cast<uint64_t>(philox_m1) * c2;
+                c0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+                c2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+                c1 = static_cast<uint32_t>(p1);
+                c3 = static_cast<uint32_t>(p0);
+                k0 += philox_w0;
+                k1 += philox_w1;
+            }
+            out[0] = c0;
+            out[1] = c1;
+            out[2] = c2;
+            out[3] = c3;
+        }
+
+        /**
+         * Calcule les groupes de 16 blocs commençant aux blocs first, first + 16, ... (ngroups groupes).
+         * Un groupe occupe 64 mots rangés par composante : le mot k du bloc i est en out[16 * k + i].
+         * Cette disposition ne dépend pas de la largeur des registres : toutes les versions donnent le même résultat.
+         */
+        inline void philox_scalar(uint64_t key, uint64_t stream, uint64_t first, size_t ngroups, uint32_t *out)
+        {
+            for (size_t g = 0; g < ngroups; ++g, out += group_words)
+                for (size_t i = 0; i < philox_group; ++i)
+                {
+                    uint32_t w[4];
+                    philox_block(key, stream, first + g * philox_group + i, w);
+                    for (size_t k = 0; k < 4; ++k)
+                        out[k * philox_group + i] = w[k];
+                }
+        }
+
+#ifdef NDARRAY_X86_DISPATCH
+        /**
+         * r = produits 32 x 32 -> 64 bits des moitiés basses des éléments de 64 bits de a et b (pmuludq).
+         * GCC ne reconnaît pas ce motif dans une multiplication de vecteurs de 64 bits ; ses fonctions
+         * intégrées ne sont vérifiées qu'une fois le code intégré dans un wrapper ciblé.
+         */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi" // Toujours intégrée : aucun vecteur ne passe par la pile
+        template <typename D>
+        NDARRAY_ALWAYS_INLINE void mul_lo32(D &r, const D &a, const D &b)
+        {
+#ifdef __clang__
+            r = (a & 0xFFFFFFFFu) * (b & 0xFFFFFFFFu); // Motif reconnu par Clang
+#else
+            if constexpr (sizeof(D) == 16)
+                r = reinterpret_cast<D>(__builtin_ia32_pmuludq128(reinterpret_cast<__v4si>(a), reinterpret_cast<__v4si>(b)));
+            else if constexpr (sizeof(D) == 32)
+                r = reinterpret_cast<D>(__builtin_ia32_pmuludq256(reinterpret_cast<__v8si>(a), reinterpret_cast<__v8si>(b)));
+            else
+                r = reinterpret_cast<D>(__builtin_ia32_pmuludq512_mask(reinterpret_cast<__v16si>(a), reinterpret_cast<__v16si>(b),
+                                                                       reinterpret_cast<__v8di>(a), static_cast<__mmask8>(-1)));
+#endif
+        }
+#pragma GCC diagnostic pop
+
+        /**
+         * Même calcul avec les extensions vectorielles de GCC/Clang : VB est la largeur d'un registre en octets.
+         * Chaque mot de l'état occupe un élément de 64 bits dont seule la moitié basse compte : pmuludq
+         * donne directement le produit 32 x 32 -> 64 bits, et la moitié haute peut contenir n'importe quoi.
+         * Le noyau est intégré dans un wrapper compilé pour le jeu d'instructions visé.
+         */
+        template <int VB, typename U32 = uint32_t, typename U64 = uint64_t> // Types dépendants : sinon GCC ignore vector_size
+        NDARRAY_ALWAYS_INLINE void philox_kernel(uint64_t key, uint64_t stream, uint64_t first, size_t ngroups, uint32_t *out)
+        {
+            typedef U64 D __attribute__((vector_size(VB)));
+            typedef U32 H __attribute__((vector_size(VB / 2)));
+            constexpr int L = VB / 8;                              // Blocs par registre
+            constexpr int NV = static_cast<int>(philox_group) / L; // Registres par mot de l'état
+            D lane;
+            for (int i = 0; i < L; ++i)
+                lane[i] = static_cast<uint64_t>(i);
+            const D m0 = D{} + philox_m0, m1 = D{} + philox_m1;
+            // Premier tour : c2 = stream et c3 = stream >> 32 sont communs à tous les blocs
+            D q1;
+            mul_lo32(q1, D{} + stream, m1);
+            const D first_c0 = (q1 >> 32) ^ static_cast<uint32_t>(key), first_c1 = q1;
+            const D first_c3 = D{} + ((stream >> 32) ^ (key >> 32));
+            for (size_t g = 0; g < ngroups; ++g, out += group_words)
+            {
+                uint64_t base = first + g * philox_group;
+                D c[4][NV]; // c[k][v] : mot k des blocs du registre v
+#pragma GCC unroll 16
+                for (int v = 0; v < NV; ++v)
+                {
+                    D ctr = lane + (base + static_cast<uint64_t>(v * L)), p0;
+                    mul_lo32(p0, ctr, m0);
+                    c[0][v] = first_c0 ^ (ctr >> 32);
+                    c[1][v] = first_c1;
+                    c[2][v] = (p0 >> 32) ^ first_c3;
+                    c[3][v] = p0;
+                }
+                uint32_t k0 = static_cast<uint32_t>(key) + philox_w0, k1 = static_cast<uint32_t>(key >> 32) + philox_w1;
+#pragma GCC unroll 9
+                for (int r = 1; r < 10; ++r)
+                {
+#pragma GCC unroll 16
+                    for (int v = 0; v < NV; ++v)
+                    {
+                        D p0, p1;
+                        mul_lo32(p0, c[0][v], m0);
+                        mul_lo32(p1, c[2][v], m1);
+                        c[0][v] = (p1 >> 32) ^ c[1][v] ^ k0;
+                        c[2][v] = (p0 >> 32) ^ c[3][v] ^ k1;
+                        c[1][v] = p1;
+                        c[3][v] = p0;
+                    }
+                    k0 += philox_w0;
+                    k1 += philox_w1;
+                }
+#pragma GCC unroll 16
+                for (int v = 0; v < NV; ++v)
+                    for (size_t k = 0; k < 4; ++k)
+                    {
+                        H h = __builtin_convertvector(c[k][v], H); // Moitiés basses
+                        std::memcpy(out + k * philox_group + v * L, &h, VB / 2);
+                    }
+            }
+        }
+
+#ifdef __SSE2__
+        inline void philox_sse2(uint64_t key, uint64_t stream, uint64_t first, size_t ngroups, uint32_t *out)
+        {
+            philox_kernel<16>(key, stream, first, ngroups, out);
+        }
+#endif
+
+        __attribute__((target("avx2"))) inline void philox_avx2(uint64_t key, uint64_t stream, uint64_t first, size_t ngroups, uint32_t *out)
+        {
+            philox_kernel<32>(key, stream, first, ngroups, out);
+        }
+
+        __attribute__((target("avx512f"))) inline void philox_avx512(uint64_t key, uint64_t stream, uint64_t first, size_t ngroups, uint32_t *out)
+        {
+            philox_kernel<64>(key, stream, first, ngroups, out);
+        }
+#endif
+
+        // Groupes Philox avec le meilleur jeu d'instructions disponible (le résultat est le même partout)
+        inline void philox_groups(uint64_t key, uint64_t stream, uint64_t first, size_t ngroups, uint32_t *out)
+        {
+#ifdef NDARRAY_X86_DISPATCH
+            switch (detect_isa())
+            {
+            case Isa::avx512:
+                return philox_avx512(key, stream, first, ngroups, out);
+            case Isa::avx2:
+                return philox_avx2(key, stream, first, ngroups, out);
+            default:
+#ifdef __SSE2__
+                return philox_sse2(key, stream, first, ngroups, out);
+#else
+                break;
+#endif
+            }
+#endif
+            philox_scalar(key, stream, first, ngroups, out);
+        }
+
+        // Mot de 64 bits formé des mots 2j et 2j + 1
+        inline uint64_t word64(const uint32_t *w, size_t j)
+        {
+            return static_cast<uint64_t>(w[2 * j]) | static_cast<uint64_t>(w[2 * j + 1]) << 32;
+        }
+
+        // Partie haute du produit 64 x 64 -> 128 bits
+        inline uint64_t mulhi64(uint64_t a, uint64_t b)
+        {
+#ifdef __SIZEOF_INT128__
+            __extension__ using u128 = unsigned __int128; // Extension GCC/Clang : pas d'avertissement -Wpedantic
+            return static_cast<uint64_t>((static_cast<u128>(a) * b) >> 64);
+#else
+            uint64_t a0 = a & 0xFFFFFFFFu, a1 = a >> 32, b0 = b & 0xFFFFFFFFu, b1 = b >> 32;
+            uint64_t mid = (a0 * b0 >> 32) + (a1 * b0 & 0xFFFFFFFFu) + a0 * b1;
+            return a1 * b1 + (a1 * b0 >> 32) + (mid >> 32);
+#endif
+        }
+
+        // Réel uniforme dans [0, 1) : 24 bits pour float, 53 bits sinon
+        inline float unit_float(uint32_t w) { return static_cast<float>(w >> 8) * 0x1p-24f; }
+        inline double unit_double(uint64_t w) { return static_cast<double>(w >> 11) * 0x1p-53; }
+
+        // Type non signé de 64 bits dans lequel un entier T est représenté pour le calcul d'un intervalle
+        template <typename T>
+        uint64_t to_u64(T x)
+        {
+            using W = std::conditional_t<std::is_signed<T>::value, int64_t, uint64_t>;
+            return static_cast<uint64_t>(static_cast<W>(x));
+        }
+    }
+
+    /**
+     * Générateur de nombres aléatoires à graine explicite : moteur Philox4x32-10, 2^64 flux
+     * indépendants de 2^64 blocs de 128 bits par graine.
+     * Chaque remplissage réserve les blocs dont il a besoin (graine, flux et position lus et avancés
+     * ensemble sous un court verrou) puis les calcule en parallèle hors verrou : un générateur peut être
+     * partagé entre threads, réaffecté (nd::seed) pendant qu'un autre thread tire des valeurs, et une
+     * même suite d'appels produit les mêmes valeurs quel que soit le nombre de threads.
+     * Les tirages scalaires (operator()) en font un UniformRandomBitGenerator utilisable avec <random>.
+     */
+    class Generator
+    {
+    public:
+        using result_type = uint64_t;
+
+        explicit Generator(uint64_t seed, uint64_t stream = 0) : state{seed, stream, 0} {}
+        Generator(const Generator &other) : state(other.snapshot()) {}
+        // Graine, flux et position sont publiés d'un seul tenant : un tirage concurrent voit l'ancien état ou le nouveau
+        Generator &operator=(const Generator &other)
+        {
+            State s = other.snapshot();
+            std::lock_guard<std::mutex> guard(lock);
+            state = s;
+            return *this;
+        }
+
+        uint64_t seed() const { return snapshot().key; }
+        uint64_t stream() const { return snapshot().stream; }
+        // Nombre de blocs de 128 bits déjà consommés
+        uint64_t position() const { return snapshot().pos; }
+        // Place le générateur sur le bloc blocks du flux (saut en temps constant)
+        void set_position(uint64_t blocks)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            state.pos = blocks;
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<uint64_t>::max(); }
+        // 64 bits aléatoires (un bloc par appel)
+        result_type operator()()
+        {
+            uint32_t w[4];
+            State s = reserve(1);
+            detail::philox_block(s.key, s.stream, s.pos, w);
+            return detail::word64(w, 0);
+        }
+
+        /**
+         * Remplit out (dans l'ordre C, vues comprises) de réels uniformes dans [low, high).
+         * float consomme 32 bits par élément, les autres types flottants 64.
+         * low + (high - low) * u peut s'arrondir à high : la valeur est alors ramenée au flottant voisin
+         * de high du côté de low, et high n'est jamais produit.
+         */
+        template <typename T>
+        void fill_uniform(NDarray<T> &out, T low = T(0), T high = T(1))
+        {
+            static_assert(std::is_floating_point<T>::value, "fill_uniform ne supporte que les types à virgule flottante");
+            T scale = high - low;
+            // Bornes de clamp : [low, last] si low <= high, [last, low] sinon
+            T last = std::nextafter(high, low); // high si low == high
+            T lo = std::min(low, last), hi = std::max(low, last);
+            if constexpr (std::is_same<T, float>::value)
+                fill<T, 64>(out, [=](const uint32_t *w, size_t nw, T *dst)
+                            {
+                    for (size_t i = 0; i < nw; ++i)
+                        dst[i] = std::min(std::max(low + scale * detail::unit_float(w[i]), lo), hi); });
+            else
+                fill<T, 32>(out, [=](const uint32_t *w, size_t nw, T *dst)
+                            {
+                    for (size_t i = 0; i < nw / 2; ++i)
+                        dst[i] = std::min(std::max(low + scale * static_cast<T>(detail::unit_double(detail::word64(w, i))), lo), hi); });
+        }
+
+        /**
+         * Remplit out de tirages de la loi normale N(mean, stddev^2) par la méthode de Box-Muller :
+         * chaque paire d'uniformes donne deux valeurs (cos et sin).
+         * @throws std::invalid_argument Si stddev est négatif.
+         */
+        template <typename T>
+        void fill_normal(NDarray<T> &out, T mean = T(0), T stddev = T(1))
+        {
+            static_assert(std::is_floating_point<T>::value, "fill_normal ne supporte que les types à virgule flottante");
+            if (stddev < T(0))
+                throw std::invalid_argument("L'écart type doit être positif ou nul");
+            constexpr T two_pi = T(6.283185307179586476925286766559);
+            if constexpr (std::is_same<T, float>::value)
+                fill<T, 64>(out, [=](const uint32_t *w, size_t nw, T *dst)
+                            {
+                    for (size_t i = 0; i < nw / 2; ++i)
+                    {
+                        float u1 = detail::unit_float(w[2 * i]) + 0x1p-24f; // Dans (0, 1] : log défini
+                        float r = stddev * std::sqrt(-2.0f * std::log(u1));
+                        float t = two_pi * detail::unit_float(w[2 * i + 1]);
+                        dst[2 * i] = mean + r * std::cos(t);
+                        dst[2 * i + 1] = mean + r * std::sin(t);
+                    } });
+            else
+                fill<T, 32>(out, [=](const uint32_t *w, size_t nw, T *dst)
+                            {
+                    for (size_t i = 0; i < nw / 4; ++i)
+                    {
+                        T u1 = static_cast<T>(detail::unit_double(detail::word64(w, 2 * i)) + 0x1p-53);
+                        T r = stddev * std::sqrt(T(-2) * std::log(u1));
+                        T t = two_pi * static_cast<T>(detail::unit_double(detail::word64(w, 2 * i + 1)));
+                        dst[2 * i] = mean + r * std::cos(t);
+                        dst[2 * i + 1] = mean + r * std::sin(t);
+                    } });
+        }
+
+        /**
+         * Remplit out d'entiers uniformes dans [low, high).
+         * Chaque élément utilise 64 bits (multiplication de Lemire, biais inférieur à (high - low) / 2^64).
+         * @throws std::invalid_argument Si low >= high.
+         */
+        template <typename T>
+        void fill_integers(NDarray<T> &out, T low, T high)
+        {
+            static_assert(std::is_integral<T>::value, "fill_integers ne supporte que les types entiers");
+            if (low >= high)
+                throw std::invalid_argument("low doit être inférieur à high");
+            fill_range(out, low, detail::to_u64(high) - detail::to_u64(low));
+        }
+
+        // Tableaux de forme dims remplis par fill_uniform, fill_normal et fill_integers
+        template <typename T>
+        NDarray<T> uniform(const std::vector<size_t> &dims, T low = T(0), T high = T(1))
+        {
+            NDarray<T> result = NDarray<T>::uninitialized(dims);
+            fill_uniform(result, low, high);
+            return result;
+        }
+        template <typename T>
+        NDarray<T> normal(const std::vector<size_t> &dims, T mean = T(0), T stddev = T(1))
+        {
+            NDarray<T> result = NDarray<T>::uninitialized(dims);
+            fill_normal(result, mean, stddev);
+            return result;
+        }
+        template <typename T>
+        NDarray<T> integers(T low, T high, const std::vector<size_t> &dims)
+        {
+            NDarray<T> result = NDarray<T>::uninitialized(dims);
+            fill_integers(result, low, high);
+            return result;
+        }
+
+        // Entiers uniformes low, low + 1, ..., low + range - 1 (range nul : les 2^64 valeurs)
+        template <typename T>
+        void fill_range(NDarray<T> &out, T low, uint64_t range)
+        {
+            uint64_t base = detail::to_u64(low);
+            fill<T, 32>(out, [=](const uint32_t *w, size_t nw, T *dst)
+                       {
+                for (size_t i = 0; i < nw / 2; ++i)
+                {
+                    uint64_t x = detail::word64(w, i);
+                    dst[i] = static_cast<T>(base + (range ? detail::mulhi64(x, range) : x));
+                } });
+        }
+
+    private:
+        /**
+         * Remplit out : les éléments sont tirés de groupes de 16 blocs consécutifs à partir de position(),
+         * PerGroup éléments par groupe, l'élément i (ordre C) venant du groupe i / PerGroup.
+         * map(words, nw, dst) convertit nw mots (un multiple de 64) en nw * PerGroup / 64 éléments.
+         * Les vues non contiguës sont remplies via un tableau temporaire.
+         */
+        template <typename T, size_t PerGroup, typename Map>
+        void fill(NDarray<T> &out, const Map &map)
+        {
+            NDARRAY_TIMED("random");
+            if (!out.is_contiguous())
+            {
+                NDarray<T> tmp = NDarray<T>::uninitialized(out.getShape());
+                fill<T, PerGroup>(tmp, map);
+                detail::evaluate(detail::wrap(static_cast<const NDarray<T> &>(tmp)), out);
+                return;
+            }
+            size_t n = out.getSize();
+            if (n == 0)
+                return;
+            T *dst = out.data();
+            size_t ngroups = (n + PerGroup - 1) / PerGroup;
+            State st = reserve(ngroups * detail::philox_group);
+            uint64_t first = st.pos, k = st.key, s = st.stream;
+            parallel_for_elements(ngroups, PerGroup, [&](size_t lo, size_t hi)
+                                  {
+                alignas(64) uint32_t words[detail::group_words * detail::random_chunk];
+                alignas(64) T tail[PerGroup];
+                for (size_t g = lo; g < hi; g += detail::random_chunk)
+                {
+                    size_t ng = std::min(detail::random_chunk, hi - g);
+                    detail::philox_groups(k, s, first + g * detail::philox_group, ng, words);
+                    T *o = dst + g * PerGroup;
+                    size_t count = std::min(ng * PerGroup, n - g * PerGroup);
+                    size_t full = count / PerGroup; // Groupes entièrement utilisés
+                    map(words, full * detail::group_words, o);
+                    if (full < ng)
+                    {
+                        map(words + full * detail::group_words, detail::group_words, tail); // Dernier groupe incomplet
+                        std::copy(tail, tail + (count - full * PerGroup), o + full * PerGroup);
+                    }
+                } });
+        }
+
+        struct State
+        {
+            uint64_t key;    // Graine (clé Philox)
+            uint64_t stream; // Numéro du flux
+            uint64_t pos;    // Prochain bloc à utiliser
+        };
+
+        State snapshot() const
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            return state;
+        }
+
+        // Lit l'état et avance la position de n blocs en une seule opération
+        State reserve(uint64_t n)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            State s = state;
+            state.pos += n;
+            return s;
+        }
+
+        mutable std::mutex lock;
+        State state; // Protégé par lock
+    };
+
+    /**
+     * Générateur partagé utilisé par NDarray::rand, randint et randn.
+     * Sa graine est tirée de std::random_device au premier appel ; seed() le rend reproductible.
+     */
+    inline Generator &default_generator()
+    {
+        static Generator *gen = new Generator((static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}());
+        return *gen;
+    }
+
+    // Réinitialise le générateur partagé avec la graine s (flux 0, position 0)
+    inline void seed(uint64_t s)
+    {
+        default_generator() = Generator(s);
+    }
+}
+
+#endif
@@ -0,0 +1,524 @@
+#ifndef NDARRAY_REDUCE_H
+#define NDARRAY_REDUCE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "ndarray_expr.h"
+#include "ndarray_instrument.h"
+#include "ndarray_parallel.h"
+
+// Moteur de réduction utilisé par NDarray::sum, mean, min, max, argmax, var...
+// Les axes conservés et les axes réduits sont simplifiés séparément (coalesce), puis l'un des
+// trois parcours suivants est choisi à partir des pas :
+//  - bloc réduit contigu : somme par paires vectorisable pour chaque sortie ;
+//  - axe conservé interne contigu : accumulation ligne par ligne, vectorisée sur les sorties ;
+//  - cas général : parcours par pas avec sommation compensée (Kahan) pour les flottants.
+// Le découpage en blocs ne dépend que de la taille des données, jamais du nombre de threads :
+// le résultat est identique quelle que soit la parallélisation.
+namespace nd
+{
+    namespace detail
+    {
+        // Type des résultats de mean/var/stddev : double pour les tableaux d'entiers
+        template <typename T>
+        using real_t = std::conditional_t<std::is_floating_point<T>::value, T, double>;
+
+        // Taille des blocs réduits indépendamment (puis combinés dans l'ordre)
+        constexpr size_t reduce_chunk = 32768;
+        // Taille des blocs dont argmin/argmax cherchent l'extremum avant d'en chercher la position
+        constexpr size_t arg_block = 1024;
+
+        // Description d'une réduction : axes conservés et axes réduits, chacun simplifié
+        struct ReduceLayout
+        {
+            std::vector<size_t> kshape, rshape;
+            std::vector<long long> kstrides, rstrides;
+            size_t nout = 1, nred = 1;
+        };
+
+        inline ReduceLayout make_layout(const std::vector<size_t> &shape, const std::vector<long long> &strides,
+                                        const std::vector<bool> &reduced)
+        {
+            ReduceLayout l;
+            StrideSet ks(1), rs(1);
+            for (size_t d = 0; d < shape.size(); ++d)
+            {
+                if (reduced[d])
+                {
+                    l.rshape.push_back(shape[d]);
+                    rs[0].push_back(strides[d]);
+                }
+                else
+                {
+                    l.kshape.push_back(shape[d]);
+                    ks[0].push_back(strides[d]);
+                }
+            }
+            for (size_t d : l.kshape)
+                l.nout *= d;
+            for (size_t d : l.rshape)
+                l.nred *= d;
+            coalesce(l.kshape, ks);
+            coalesce(l.rshape, rs);
+            l.kstrides = ks[0];
+            l.rstrides = rs[0];
+            return l;
+        }
+
+        // Position (relative) de l'élément d'index plat i dans un espace de forme shape et de pas strides
+        inline long long unravel_offset(size_t i, const std::vector<size_t> &shape, const std::vector<long long> &strides)
+        {
+            long long off = 0;
+            for (size_t d = shape.size(); d > 0; --d)
+            {
+                off += static_cast<long long>(i % shape[d - 1]) * strides[d - 1];
+                i /= shape[d - 1];
+            }
+            return off;
+        }
+
+        // Parcourt les positions d'un espace multi-dimensionnel dans l'ordre C
+        struct Odometer
+        {
+            const std::vector<size_t> &shape;
+            const std::vector<long long> &strides;
+            std::vector<size_t> idx;
+            long long pos = 0;
+
+            Odometer(const std::vector<size_t> &s, const std::vector<long long> &st, size_t start = 0)
+                : shape(s), strides(st), idx(s.size(), 0)
+            {
+                for (size_t d = s.size(); d > 0; --d)
+                {
+                    idx[d - 1] = start % s[d - 1];
+                    pos += static_cast<long long>(idx[d - 1]) * st[d - 1];
+                    start /= s[d - 1];
+                }
+            }
+            void next()
+            {
+                for (size_t d = shape.size(); d > 0; --d)
+                {
+                    pos += strides[d - 1];
+                    if (++idx[d - 1] < shape[d - 1])
+                        return;
+                    pos -= strides[d - 1] * static_cast<long long>(shape[d - 1]);
+                    idx[d - 1] = 0;
+                }
+            }
+        };
+
+        // Réducteurs : map transforme un élément (ctx = moyenne pour var), step l'accumule, merge combine deux résultats.
+        // nan_check : step ignore les NaN (sélection sans branchement, vectorisable) ; ils sont détectés à part
+        // et seul merge les propage.
+        template <typename T, typename A>
+        struct SumReducer
+        {
+            static constexpr bool additive = true; // Sommation par paires / compensée
+            static constexpr bool nan_check = false;
+            static A init() { return A(0); }
+            static A map(T v, A) { return static_cast<A>(v); }
+            static void step(A &acc, A v) { acc += v; }
+            static A merge(A a, A b) { return a + b; }
+        };
+        template <typename T, typename A>
+        struct SqDevReducer : SumReducer<T, A>
+        {
+            static A map(T v, A center)
+            {
+                A d = static_cast<A>(v) - center;
+                return d * d;
+            }
+        };
+        template <typename T, typename A>
+        struct ProdReducer
+        {
+            static constexpr bool additive = false;
+            static constexpr bool nan_check = false;
+            static A init() { return A(1); }
+            static A map(T v, A) { return static_cast<A>(v); }
+            static void step(A &acc, A v) { acc *= v; }
+            static A merge(A a, A b) { return a * b; }
+        };
+        // Minimum et maximum propagent NaN, comme NumPy
+        template <typename T, typename A>
+        struct MinReducer
+        {
+            static constexpr bool additive = false;
+            static constexpr bool nan_check = std::is_floating_point<A>::value;
+            static A init() { return std::numeric_limits<A>::has_infinity ? std::numeric_limits<A>::infinity() : std::numeric_limits<A>::max(); }
+            static A map(T v, A) { return static_cast<A>(v); }
+            static void step(A &acc, A v) { acc = v < acc ? v : acc; }
+            static A merge(A a, A b) { return (b < a || b != b) ? b : a; }
+        };
+        template <typename T, typename A>
+        struct MaxReducer
+        {
+            static constexpr bool additive = false;
+            static constexpr bool nan_check = std::is_floating_point<A>::value;
+            static A init() { return std::numeric_limits<A>::has_infinity ? -std::numeric_limits<A>::infinity() : std::numeric_limits<A>::lowest(); }
+            static A map(T v, A) { return static_cast<A>(v); }
+            static void step(A &acc, A v) { acc = v > acc ? v : acc; }
+            static A merge(A a, A b) { return (b > a || b != b) ? b : a; }
+        };
+
+        // Accumulateur avec compensation de Kahan pour les sommes flottantes parcourues par pas
+        template <typename A>
+        struct Kahan
+        {
+            A sum = A(0), comp = A(0);
+            void add(A v)
+            {
+                if constexpr (std::is_floating_point<A>::value)
+                {
+                    A y = v - comp;
+                    A t = sum + y;
+                    comp = (t - sum) - y;
+                    sum = t;
+                }
+                else
+                    sum += v;
+            }
+        };
+
+        /**
+         * Réduit un bloc contigu avec des accumulateurs indépendants (vectorisables) : huit, par paires,
+         * pour les sommes ; 32 pour les autres réducteurs, dont la sélection est vectorisée par la boucle
+         * sur les accumulateurs. Pour nan_check, v - v (NaN pour NaN et ±inf) est sommé à part et le bloc
+         * n'est relu, pour trouver un éventuel NaN, que si cette somme est NaN.
+         */
+        template <typename R, typename T, typename A>
+        A reduce_block(const T *x, size_t n, A ctx)
+        {
+            if constexpr (R::additive)
+            {
+                if (n > 128)
+                {
+                    size_t half = (n / 2) / 8 * 8;
+                    return R::merge(reduce_block<R>(x, half, ctx), reduce_block<R>(x + half, n - half, ctx));
+                }
+                A acc[8];
+                for (A &a : acc)
+                    a = R::init();
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                    for (size_t k = 0; k < 8; ++k)
+                        R::step(acc[k], R::map(x[i + k], ctx));
+                A rest = R::init();
+                for (; i < n; ++i)
+                    R::step(rest, R::map(x[i], ctx));
+                return R::merge(R::merge(R::merge(acc[0], acc[1]), R::merge(acc[2], acc[3])),
+                                R::merge(R::merge(R::merge(acc[4], acc[5]), R::merge(acc[6], acc[7])), rest));
+            }
+            else
+            {
+                constexpr size_t W = 32;
+                A acc[W], chk[W];
+                for (size_t k = 0; k < W; ++k)
+                {
+                    acc[k] = R::init();
+                    chk[k] = A(0);
+                }
+                size_t i = 0;
+                for (; i + W <= n; i += W)
+                {
+#pragma GCC unroll 1 // Laisse la boucle au vectoriseur (le déroulage complet l'empêche de convertir la sélection)
+                    for (size_t k = 0; k < W; ++k)
+                    {
+                        A v = R::map(x[i + k], ctx);
+                        R::step(acc[k], v);
+                        if constexpr (R::nan_check)
+                            chk[k] += v - v;
+                    }
+                }
+                for (size_t k = 0; i < n; ++i, ++k)
+                {
+                    A v = R::map(x[i], ctx);
+                    R::step(acc[k], v);
+                    if constexpr (R::nan_check)
+                        chk[k] += v - v;
+                }
+                A r = acc[0];
+                for (size_t k = 1; k < W; ++k)
+                    r = R::merge(r, acc[k]);
+                if constexpr (R::nan_check)
+                {
+                    A c = A(0);
+                    for (size_t k = 0; k < W; ++k)
+                        c += chk[k];
+                    if (c != c) // NaN ou infini dans le bloc : recherche exacte d'un NaN
+                        for (size_t j = 0; j < n; ++j)
+                        {
+                            A v = R::map(x[j], ctx);
+                            if (v != v)
+                                return v;
+                        }
+                }
+                return r;
+            }
+        }
+
+        // Combine des résultats partiels dans l'ordre, par paires
+        template <typename R, typename A>
+        A merge_pairwise(const A *part, size_t n)
+        {
+            if (n == 1)
+                return part[0];
+            size_t half = n / 2;
+            return R::merge(merge_pairwise<R>(part, half), merge_pairwise<R>(part + half, n - half));
+        }
+
+        /**
+         * Réduit src (pointeur vers le premier élément logique) selon layout et écrit les nout
+         * résultats dans out (ordre C des axes conservés). ctx, s'il est fourni, contient une
+         * valeur par sortie transmise à R::map (la moyenne pour la variance).
+         */
+        template <typename R, typename T, typename A>
+        void reduce(const T *src, const ReduceLayout &l, A *out, const A *ctx = nullptr)
+        {
+            NDARRAY_TIMED("reduce");
+            auto ctx_of = [ctx](size_t o)
+            { return ctx ? ctx[o] : A(0); };
+            size_t nout = l.nout, nred = l.nred;
+            if (nred == 0)
+            {
+                std::fill(out, out + nout, R::init());
+                return;
+            }
+
+            // Bloc réduit contigu
+            if (l.rshape.size() == 1 && l.rstrides[0] == 1)
+            {
+                if (nred > reduce_chunk)
+                {
+                    // Blocs fixes réduits en parallèle puis combinés dans l'ordre
+                    size_t nchunks = (nred + reduce_chunk - 1) / reduce_chunk;
+                    std::vector<A> part(nout * nchunks);
+                    parallel_for(0, nout * nchunks, 1, [&](size_t lo, size_t hi)
+                                 {
+                        for (size_t t = lo; t < hi; ++t)
+                        {
+                            size_t o = t / nchunks, c = t % nchunks;
+                            size_t len = std::min(reduce_chunk, nred - c * reduce_chunk);
+                            const T *x = src + unravel_offset(o, l.kshape, l.kstrides) + static_cast<long long>(c * reduce_chunk);
+                            part[t] = reduce_block<R>(x, len, ctx_of(o));
+                        } });
+                    for (size_t o = 0; o < nout; ++o)
+                        out[o] = merge_pairwise<R>(part.data() + o * nchunks, nchunks);
+                    return;
+                }
+                parallel_for(0, nout, std::max<size_t>(1, reduce_chunk / nred), [&](size_t lo, size_t hi)
+                             {
+                    Odometer k(l.kshape, l.kstrides, lo);
+                    for (size_t o = lo; o < hi; ++o, k.next())
+                        out[o] = reduce_block<R>(src + k.pos, nred, ctx_of(o)); });
+                return;
+            }
+
+            // Axe conservé interne contigu : chaque ligne réduite est accumulée dans un bloc de sorties.
+            // L'étendue réduite est découpée en tranches fixes de lignes (parallélisme pour les tableaux
+            // hauts et étroits), dont les résultats partiels sont combinés dans l'ordre.
+            size_t inner = l.kshape.back();
+            if (l.kstrides.back() == 1 && inner >= 8)
+            {
+                constexpr size_t cols = 256;
+                size_t nblk = (inner + cols - 1) / cols, nouter = nout / inner;
+                size_t rows = std::max<size_t>(1, reduce_chunk / std::min(cols, inner));
+                size_t nch = (nred + rows - 1) / rows;
+                std::vector<A> part(nch > 1 ? nout * nch : 0);
+                parallel_for(0, nouter * nblk * nch, std::max<size_t>(1, reduce_chunk / (std::min(rows, nred) * cols)), [&](size_t lo, size_t hi)
+                             {
+                    A acc[cols], comp[cols], cv[cols], chk[cols];
+                    std::vector<size_t> kouter(l.kshape.begin(), l.kshape.end() - 1);
+                    std::vector<long long> souter(l.kstrides.begin(), l.kstrides.end() - 1);
+                    for (size_t t = lo; t < hi; ++t)
+                    {
+                        size_t c = t % nch, ob = t / nch / nblk, j0 = (t / nch % nblk) * cols, len = std::min(cols, inner - j0);
+                        size_t o0 = ob * inner + j0, i0 = c * rows, n = std::min(rows, nred - i0);
+                        const T *base = src + unravel_offset(ob, kouter, souter) + static_cast<long long>(j0);
+                        for (size_t j = 0; j < len; ++j)
+                        {
+                            acc[j] = R::init();
+                            comp[j] = A(0);
+                            chk[j] = A(0);
+                            cv[j] = ctx_of(o0 + j);
+                        }
+                        Odometer r(l.rshape, l.rstrides, i0);
+                        for (size_t i = 0; i < n; ++i, r.next())
+                        {
+                            const T *x = base + r.pos;
+                            if constexpr (R::additive && std::is_floating_point<A>::value)
+                            {
+                                for (size_t j = 0; j < len; ++j)
+                                {
+                                    // Sommation de Kahan, vectorisée sur les colonnes
+                                    A y = R::map(x[j], cv[j]) - comp[j];
+                                    A s = acc[j] + y;
+                                    comp[j] = (s - acc[j]) - y;
+                                    acc[j] = s;
+                                }
+                            }
+                            else
+                            {
+                                for (size_t j = 0; j < len; ++j)
+                                {
+                                    A v = R::map(x[j], cv[j]);
+                                    R::step(acc[j], v);
+                                    if constexpr (R::nan_check)
+                                        chk[j] += v - v;
+                                }
+                            }
+                        }
+                        if constexpr (R::nan_check)
+                        {
+                            // Colonnes contenant NaN ou infini : recherche exacte d'un NaN
+                            for (size_t j = 0; j < len; ++j)
+                                if (chk[j] != chk[j])
+                                {
+                                    Odometer rn(l.rshape, l.rstrides, i0);
+                                    for (size_t i = 0; i < n; ++i, rn.next())
+                                        acc[j] = R::merge(acc[j], R::map(base[rn.pos + static_cast<long long>(j)], cv[j]));
+                                }
+                        }
+                        if (nch == 1)
+                            std::copy(acc, acc + len, out + o0);
+                        else
+                            for (size_t j = 0; j < len; ++j)
+                                part[(o0 + j) * nch + c] = acc[j];
+                    } });
+                if (nch > 1)
+                    for (size_t o = 0; o < nout; ++o)
+                        out[o] = merge_pairwise<R>(part.data() + o * nch, nch);
+                return;
+            }
+
+            // Cas général : chaque sortie est découpée en tranches fixes de reduce_chunk éléments réduits,
+            // réduites en parallèle puis combinées dans l'ordre (résultat indépendant du nombre de threads)
+            size_t nch = (nred + reduce_chunk - 1) / reduce_chunk;
+            std::vector<A> part(nch > 1 ? nout * nch : 0);
+            parallel_for(0, nout * nch, std::max<size_t>(1, reduce_chunk / std::min(nred, reduce_chunk)), [&](size_t lo, size_t hi)
+                         {
+                Odometer k(l.kshape, l.kstrides, lo / nch);
+                for (size_t t = lo; t < hi; ++t)
+                {
+                    size_t o = t / nch, c = t % nch, i0 = c * reduce_chunk, n = std::min(reduce_chunk, nred - i0);
+                    if (t > lo && c == 0)
+                        k.next();
+                    const T *base = src + k.pos;
+                    Odometer r(l.rshape, l.rstrides, i0);
+                    A acc;
+                    if constexpr (R::additive)
+                    {
+                        Kahan<A> kahan;
+                        for (size_t i = 0; i < n; ++i, r.next())
+                            kahan.add(R::map(base[r.pos], ctx_of(o)));
+                        acc = kahan.sum;
+                    }
+                    else
+                    {
+                        acc = R::init();
+                        for (size_t i = 0; i < n; ++i, r.next())
+                            acc = R::merge(acc, R::map(base[r.pos], ctx_of(o))); // merge : NaN propagé sans détection à part
+                    }
+                    if (nch == 1)
+                        out[o] = acc;
+                    else
+                        part[t] = acc;
+                } });
+            if (nch > 1)
+                for (size_t o = 0; o < nout; ++o)
+                    out[o] = merge_pairwise<R>(part.data() + o * nch, nch);
+        }
+
+        /**
+         * Index (dans l'ordre C des axes réduits) du minimum (Max = false) ou du maximum de chaque sortie.
+         * La première occurrence est retenue ; un NaN l'emporte sur toute autre valeur.
+         */
+        template <bool Max, typename T>
+        void arg_reduce(const T *src, const ReduceLayout &l, size_t *out)
+        {
+            NDARRAY_TIMED("arg_reduce");
+            if (l.nred == 0)
+                throw std::invalid_argument("Réduction impossible sur un tableau vide");
+            if (l.rshape.size() == 1 && l.rstrides[0] == 1)
+            {
+                // Bloc réduit contigu : extremum vectorisé de chaque bloc de arg_block éléments (en parallèle),
+                // puis premier bloc qui l'atteint et première position dans ce bloc
+                using Red = std::conditional_t<Max, MaxReducer<T, T>, MinReducer<T, T>>;
+                size_t nred = l.nred, nb = (nred + arg_block - 1) / arg_block;
+                std::vector<T> part(l.nout * nb);
+                parallel_for(0, l.nout * nb, reduce_chunk / arg_block, [&](size_t lo, size_t hi)
+                             {
+                    for (size_t t = lo; t < hi; ++t)
+                    {
+                        size_t o = t / nb, b = t % nb;
+                        const T *x = src + unravel_offset(o, l.kshape, l.kstrides) + static_cast<long long>(b * arg_block);
+                        part[t] = reduce_block<Red>(x, std::min(arg_block, nred - b * arg_block), T(0));
+                    } });
+                parallel_for(0, l.nout, std::max<size_t>(1, reduce_chunk / nb), [&](size_t lo, size_t hi)
+                             {
+                    for (size_t o = lo; o < hi; ++o)
+                    {
+                        const T *p = part.data() + o * nb;
+                        size_t bb = 0;
+                        for (size_t b = 1; b < nb && !(p[bb] != p[bb]); ++b)
+                            if ((Max ? p[b] > p[bb] : p[b] < p[bb]) || p[b] != p[b])
+                                bb = b;
+                        T best = p[bb];
+                        bool nan = best != best;
+                        const T *x = src + unravel_offset(o, l.kshape, l.kstrides) + static_cast<long long>(bb * arg_block);
+                        size_t len = std::min(arg_block, nred - bb * arg_block), i = 0;
+                        while (i + 1 < len && !(nan ? x[i] != x[i] : x[i] == best))
+                            ++i;
+                        out[o] = bb * arg_block + i;
+                    } });
+                return;
+            }
+            // Cas général : tranches fixes de reduce_chunk éléments réduits par sortie, chacune donnant son
+            // extremum et sa première position ; la première tranche qui atteint l'extremum l'emporte
+            size_t nch = (l.nred + reduce_chunk - 1) / reduce_chunk;
+            std::vector<T> best(l.nout * nch);
+            std::vector<size_t> best_i(l.nout * nch);
+            parallel_for(0, l.nout * nch, std::max<size_t>(1, reduce_chunk / std::min(l.nred, reduce_chunk)), [&](size_t lo, size_t hi)
+                         {
+                Odometer k(l.kshape, l.kstrides, lo / nch);
+                for (size_t t = lo; t < hi; ++t)
+                {
+                    size_t c = t % nch, i0 = c * reduce_chunk, n = std::min(reduce_chunk, l.nred - i0);
+                    if (t > lo && c == 0)
+                        k.next();
+                    const T *base = src + k.pos;
+                    Odometer r(l.rshape, l.rstrides, i0);
+                    T b = base[r.pos];
+                    size_t bi = i0;
+                    for (size_t i = 0; i < n && !(b != b); ++i, r.next())
+                    {
+                        T v = base[r.pos];
+                        if ((Max ? v > b : v < b) || v != v)
+                        {
+                            b = v;
+                            bi = i0 + i;
+                        }
+                    }
+                    best[t] = b;
+                    best_i[t] = bi;
+                } });
+            for (size_t o = 0; o < l.nout; ++o)
+            {
+                size_t bb = o * nch;
+                for (size_t t = bb + 1; t < (o + 1) * nch && !(best[bb] != best[bb]); ++t)
+                    if ((Max ? best[t] > best[bb] : best[t] < best[bb]) || best[t] != best[t])
+                        bb = t;
+                out[o] = best_i[bb];
+            }
+        }
+    }
+}
+
+#endif
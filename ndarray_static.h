@@ -0,0 +1,122 @@
+#ifndef NDARRAY_STATIC_H
+#define NDARRAY_STATIC_H
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "ndarray_fwd.h"
+#include "ndarray_instrument.h"
+#include "ndarray_memory.h"
+
+namespace nd
+{
+    // Taille du tampon interne des tableaux de rang statique : les petits tableaux n'allouent rien
+    constexpr size_t inline_bytes = 128;
+}
+
+// Classe NDarray<T, N> : tableau de rang N fixé à la compilation
+// La forme et les pas sont des std::array (aucune allocation), le calcul de position est
+// déroulé à la compilation et les tableaux d'au plus inline_capacity éléments sont stockés
+// dans l'objet lui-même. Les plus grands utilisent un tampon partagé, comme NDarray<T>.
+// La copie est profonde et contiguë ; dynamic() et le constructeur depuis NDarray<T>
+// font le lien avec la version de rang dynamique, et les opérateurs + - * / acceptent
+// les deux versions (le résultat est un NDarray<T>, ou un NDarray<T, N> par conversion).
+template <typename T, size_t N>
+class NDarray
+{
+    static_assert(N > 0, "Le rang statique doit être au moins 1");
+
+    template <typename U, size_t M>
+    friend class NDarray;
+
+public:
+    using value_type = T;                                    // Type des éléments
+    static constexpr size_t rank = N;                        // Nombre de dimensions
+    static constexpr size_t inline_capacity = nd::inline_bytes / sizeof(T) > 0 ? nd::inline_bytes / sizeof(T) : 1;
+
+    // Initialise un tableau de forme dims, tous les éléments valant value
+    explicit NDarray(const std::array<size_t, N> &dims, T value = T());
+    /**
+     * @brief Vue de rang statique sur un tableau de rang dynamique (aucune copie).
+     * @throws std::invalid_argument Si le nombre de dimensions de other n'est pas N.
+     */
+    explicit NDarray(const NDarray<T> &other);
+    /**
+     * @brief Évalue une expression élément par élément (a + b * 2, ...) dans un nouveau tableau.
+     * @throws std::invalid_argument Si l'expression n'a pas N dimensions.
+     */
+    template <typename E, typename = std::enable_if_t<nd::detail::is_expr<E>::value>>
+    NDarray(E &&expr);
+
+    // Copie profonde (le résultat est contigu) ; le déplacement conserve le tampon partagé
+    NDarray(const NDarray<T, N> &other);
+    NDarray(NDarray<T, N> &&other) noexcept;
+    NDarray<T, N> &operator=(const NDarray<T, N> &other);
+    NDarray<T, N> &operator=(NDarray<T, N> &&other) noexcept;
+    template <typename E, typename = std::enable_if_t<nd::detail::is_expr<E>::value>>
+    NDarray<T, N> &operator=(E &&expr);
+
+    static NDarray<T, N> zeros(const std::array<size_t, N> &dims);
+    static NDarray<T, N> full(const std::array<size_t, N> &dims, T value);
+
+    // Accès sans vérification : a(i, j, k), position calculée sans boucle
+    template <typename... I, typename = std::enable_if_t<sizeof...(I) == N && (std::is_integral<I>::value && ...)>>
+    T &operator()(I... idx) noexcept { return base[linear(std::make_index_sequence<N>(), idx...)]; }
+    template <typename... I, typename = std::enable_if_t<sizeof...(I) == N && (std::is_integral<I>::value && ...)>>
+    const T &operator()(I... idx) const noexcept { return base[linear(std::make_index_sequence<N>(), idx...)]; }
+
+    // Accès avec vérification des bornes
+    // @throws std::out_of_range Si un index dépasse la dimension correspondante
+    template <typename... I, typename = std::enable_if_t<sizeof...(I) == N && (std::is_integral<I>::value && ...)>>
+    T &at(I... idx);
+    template <typename... I, typename = std::enable_if_t<sizeof...(I) == N && (std::is_integral<I>::value && ...)>>
+    const T &at(I... idx) const;
+
+    const std::array<size_t, N> &getShape() const { return shape; }
+    const std::array<long long, N> &getStrides() const { return strides; }
+    size_t getSize() const { return total_size; }
+    bool is_contiguous() const;
+    // Vrai si les éléments sont stockés dans l'objet (petit tableau)
+    bool is_inline() const { return !storage; }
+    T *data() { return base; }
+    const T *data() const { return base; }
+
+    // Remplit le tableau avec value
+    void fill(T value);
+    // Vue de rang dynamique sur les éléments (sans copie) ; pour un tableau interne, elle ne possède
+    // pas les éléments et ne doit pas survivre au tableau ni à son déplacement
+    NDarray<T> dynamic() const;
+    // Affiche le tableau
+    void print() const;
+
+private:
+    // Position d'un élément par rapport à base, déroulée sur les N dimensions
+    template <size_t... K, typename... I>
+    long long linear(std::index_sequence<K...>, I... idx) const noexcept
+    {
+        return ((static_cast<long long>(idx) * strides[K]) + ...);
+    }
+    template <size_t... K, typename... I>
+    bool in_bounds(std::index_sequence<K...>, I... idx) const noexcept
+    {
+        return ((static_cast<size_t>(idx) < shape[K]) && ...);
+    }
+    // Calcule les pas contigus et choisit le stockage (interne ou tampon alloué)
+    void allocate_contiguous();
+    // Copie les éléments de other dans l'ordre C vers base (tableau contigu de même forme)
+    void copy_from(const NDarray<T, N> &other);
+
+    std::array<size_t, N> shape{};      // Dimensions du tableau
+    std::array<long long, N> strides{}; // Pas de chaque dimension
+    size_t total_size = 0;              // Nombre total d'éléments
+    std::shared_ptr<T[]> storage;       // Tampon partagé ; vide si les éléments sont internes
+    T *base = nullptr;                  // Premier élément (dans local ou dans storage)
+    alignas(nd::buffer_alignment) T local[inline_capacity];
+};
+
+#include "ndarray_static.tpp"
+#endif
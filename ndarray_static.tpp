@@ -0,0 +1,220 @@
+#include "ndarray_static.h"
+#include <algorithm>
+#include <vector>
+
+// Calcule les pas contigus (ordre C) et place les éléments dans l'objet ou dans un tampon alloué
+template <typename T, size_t N>
+void NDarray<T, N>::allocate_contiguous()
+{
+    size_t tsize = 1;
+    for (size_t i = N; i > 0; --i)
+    {
+        strides[i - 1] = static_cast<long long>(tsize);
+        tsize *= shape[i - 1];
+    }
+    total_size = tsize;
+    if (total_size <= inline_capacity)
+    {
+        storage.reset();
+        base = local;
+    }
+    else
+    {
+        storage = nd::detail::allocate_buffer<T>(total_size);
+        base = storage.get();
+    }
+}
+
+template <typename T, size_t N>
+NDarray<T, N>::NDarray(const std::array<size_t, N> &dims, T value) : shape(dims)
+{
+    allocate_contiguous();
+    fill(value);
+}
+
+// Vue sur le tampon d'un tableau de rang dynamique
+template <typename T, size_t N>
+NDarray<T, N>::NDarray(const NDarray<T> &other)
+{
+    if (other.shape.size() != N)
+        throw std::invalid_argument("Le nombre de dimensions du tableau ne correspond pas au rang statique");
+    std::copy(other.shape.begin(), other.shape.end(), shape.begin());
+    std::copy(other.strides.begin(), other.strides.end(), strides.begin());
+    total_size = other.total_size;
+    storage = other.storage;
+    base = storage.get() + other.offset;
+}
+
+// Évalue l'expression directement dans les éléments du nouveau tableau (internes ou alloués)
+template <typename T, size_t N>
+template <typename E, typename>
+NDarray<T, N>::NDarray(E &&expr)
+{
+    static_assert(std::is_same<typename std::decay_t<E>::value_type, T>::value,
+                  "Le type des éléments de l'expression doit correspondre à celui du tableau");
+    const auto &dims = expr.shape();
+    if (dims.size() != N)
+        throw std::invalid_argument("Le nombre de dimensions de l'expression ne correspond pas au rang statique");
+    std::copy(dims.begin(), dims.end(), shape.begin());
+    allocate_contiguous();
+    if (is_inline() && expr.flat_ok(dims))
+    {
+        // Petit tableau, opérandes lus à plat : boucle directe, sans vue ni répartition entre threads
+        for (size_t i = 0; i < total_size; ++i)
+            base[i] = expr.flat(i);
+        return;
+    }
+    NDarray<T> view = dynamic();
+    nd::detail::evaluate(expr, view);
+}
+
+template <typename T, size_t N>
+template <typename E, typename>
+NDarray<T, N> &NDarray<T, N>::operator=(E &&expr)
+{
+    NDarray<T, N> result(std::forward<E>(expr));
+    return *this = std::move(result);
+}
+
+template <typename T, size_t N>
+NDarray<T, N>::NDarray(const NDarray<T, N> &other) : shape(other.shape)
+{
+    allocate_contiguous();
+    copy_from(other);
+}
+
+template <typename T, size_t N>
+NDarray<T, N>::NDarray(NDarray<T, N> &&other) noexcept
+    : shape(other.shape), strides(other.strides), total_size(other.total_size), storage(std::move(other.storage))
+{
+    if (storage)
+    {
+        base = other.base;
+    }
+    else
+    {
+        std::move(other.local, other.local + total_size, local); // Les éléments internes sont déplacés un à un
+        base = local;
+    }
+}
+
+template <typename T, size_t N>
+NDarray<T, N> &NDarray<T, N>::operator=(const NDarray<T, N> &other)
+{
+    if (this != &other)
+    {
+        NDarray<T, N> tmp(other);
+        *this = std::move(tmp);
+    }
+    return *this;
+}
+
+template <typename T, size_t N>
+NDarray<T, N> &NDarray<T, N>::operator=(NDarray<T, N> &&other) noexcept
+{
+    if (this != &other)
+    {
+        shape = other.shape;
+        strides = other.strides;
+        total_size = other.total_size;
+        storage = std::move(other.storage);
+        if (storage)
+        {
+            base = other.base;
+        }
+        else
+        {
+            std::move(other.local, other.local + total_size, local);
+            base = local;
+        }
+    }
+    return *this;
+}
+
+template <typename T, size_t N>
+NDarray<T, N> NDarray<T, N>::zeros(const std::array<size_t, N> &dims)
+{
+    return NDarray<T, N>(dims, T(0));
+}
+
+template <typename T, size_t N>
+NDarray<T, N> NDarray<T, N>::full(const std::array<size_t, N> &dims, T value)
+{
+    return NDarray<T, N>(dims, value);
+}
+
+template <typename T, size_t N>
+template <typename... I, typename>
+T &NDarray<T, N>::at(I... idx)
+{
+    if (!in_bounds(std::make_index_sequence<N>(), idx...))
+        throw std::out_of_range("Index hors des limites");
+    return base[linear(std::make_index_sequence<N>(), idx...)];
+}
+
+template <typename T, size_t N>
+template <typename... I, typename>
+const T &NDarray<T, N>::at(I... idx) const
+{
+    if (!in_bounds(std::make_index_sequence<N>(), idx...))
+        throw std::out_of_range("Index hors des limites");
+    return base[linear(std::make_index_sequence<N>(), idx...)];
+}
+
+// Vrai si les pas correspondent à l'ordre C (les dimensions de taille 1 sont ignorées)
+template <typename T, size_t N>
+bool NDarray<T, N>::is_contiguous() const
+{
+    long long expected = 1;
+    for (size_t i = N; i > 0; --i)
+    {
+        if (shape[i - 1] != 1 && strides[i - 1] != expected)
+            return total_size == 0;
+        expected *= static_cast<long long>(shape[i - 1]);
+    }
+    return true;
+}
+
+template <typename T, size_t N>
+void NDarray<T, N>::fill(T value)
+{
+    if (is_contiguous())
+    {
+        std::fill(base, base + total_size, value);
+        return;
+    }
+    NDarray<T> view = dynamic(); // Vue non contiguë sur un tableau dynamique : écriture par pas
+    nd::detail::evaluate(nd::detail::ScalarLeaf<T>(value), view);
+}
+
+// Copie les éléments de other dans l'ordre C vers base
+template <typename T, size_t N>
+void NDarray<T, N>::copy_from(const NDarray<T, N> &other)
+{
+    if (other.is_contiguous())
+    {
+        NDARRAY_COUNT_COPY(total_size * sizeof(T));
+        std::copy(other.base, other.base + total_size, base);
+    }
+    else
+        other.dynamic().copy_to(base); // Vue non contiguë : parcours par pas
+}
+
+template <typename T, size_t N>
+NDarray<T> NDarray<T, N>::dynamic() const
+{
+    std::vector<size_t> dims(shape.begin(), shape.end());
+    std::vector<long long> steps(strides.begin(), strides.end());
+    if (storage)
+        return NDarray<T>(storage, static_cast<size_t>(base - storage.get()), dims, steps);
+    // Éléments internes : pointeur sans propriétaire (constructeur d'alias), que l'évaluation
+    // d'une expression ne prend jamais pour tampon réutilisable (use_count() nul)
+    std::shared_ptr<T[]> view(std::shared_ptr<T[]>(), const_cast<T *>(base));
+    return NDarray<T>(view, 0, dims, steps);
+}
+
+template <typename T, size_t N>
+void NDarray<T, N>::print() const
+{
+    dynamic().print();
+}